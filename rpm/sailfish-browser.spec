@@ -15,6 +15,7 @@ BuildRequires:  pkgconfig(qt5embedwidget) >= 1.9.4
 BuildRequires:  pkgconfig(Qt5DBus)
 BuildRequires:  pkgconfig(Qt5Concurrent)
 BuildRequires:  pkgconfig(Qt5Sql)
+BuildRequires:  pkgconfig(sqlite3)
 BuildRequires:  pkgconfig(nemotransferengine-qt5)
 BuildRequires:  pkgconfig(mlite5)
 BuildRequires:  pkgconfig(qdeclarative5-boostable)
@@ -0,0 +1,144 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "backforwardcache.h"
+
+#include <QDataStream>
+
+BackForwardCache::Entry::Entry()
+    : sequence(0)
+{
+}
+
+/**
+ * Creates a cache that holds at most \a maxSize bytes of session histories,
+ * and at most \a maxEntriesPerTab history entries per tab.
+ */
+BackForwardCache::BackForwardCache(int maxSize, int maxEntriesPerTab)
+    : m_maxSize(maxSize)
+    , m_maxEntriesPerTab(maxEntriesPerTab)
+    , m_size(0)
+    , m_sequence(0)
+{
+}
+
+void BackForwardCache::storeContentRect(int tabId, const QString &url, const QRectF &contentRect)
+{
+    findOrCreate(tabId, url)->contentRect = contentRect;
+}
+
+const BackForwardCache::Entry *BackForwardCache::find(int tabId, const QString &url) const
+{
+    QHash<int, QList<Entry> >::const_iterator tabEntries = m_entries.constFind(tabId);
+    if (tabEntries != m_entries.constEnd()) {
+        for (int i = 0; i < tabEntries->count(); ++i) {
+            if (tabEntries->at(i).url == url) {
+                return &tabEntries->at(i);
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Stores serialized engine session history of a tab. It is used to restore history
+ * of the engine when the page of the tab is created again.
+ */
+void BackForwardCache::setSessionHistory(int tabId, const QVariant &sessionHistory)
+{
+    m_size -= m_sessionHistories.value(tabId).size();
+    m_sessionHistoryOrder.removeOne(tabId);
+    if (!sessionHistory.isValid()) {
+        m_sessionHistories.remove(tabId);
+        return;
+    }
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << sessionHistory;
+    data = qCompress(data);
+    m_size += data.size();
+    m_sessionHistories.insert(tabId, data);
+    m_sessionHistoryOrder.append(tabId);
+    evict();
+}
+
+QVariant BackForwardCache::sessionHistory(int tabId) const
+{
+    QVariant sessionHistory;
+    QByteArray data = m_sessionHistories.value(tabId);
+    if (!data.isEmpty()) {
+        QDataStream in(qUncompress(data));
+        in >> sessionHistory;
+    }
+    return sessionHistory;
+}
+
+void BackForwardCache::remove(int tabId)
+{
+    m_entries.remove(tabId);
+    m_size -= m_sessionHistories.take(tabId).size();
+    m_sessionHistoryOrder.removeOne(tabId);
+}
+
+void BackForwardCache::clear()
+{
+    m_entries.clear();
+    m_sessionHistories.clear();
+    m_sessionHistoryOrder.clear();
+    m_size = 0;
+}
+
+int BackForwardCache::size() const
+{
+    return m_size;
+}
+
+int BackForwardCache::maxSize() const
+{
+    return m_maxSize;
+}
+
+BackForwardCache::Entry *BackForwardCache::findOrCreate(int tabId, const QString &url)
+{
+    QList<Entry> &tabEntries = m_entries[tabId];
+    for (int i = 0; i < tabEntries.count(); ++i) {
+        if (tabEntries.at(i).url == url) {
+            tabEntries[i].sequence = ++m_sequence;
+            return &tabEntries[i];
+        }
+    }
+
+    if (tabEntries.count() >= m_maxEntriesPerTab) {
+        int oldest = 0;
+        for (int i = 1; i < tabEntries.count(); ++i) {
+            if (tabEntries.at(i).sequence < tabEntries.at(oldest).sequence) {
+                oldest = i;
+            }
+        }
+        tabEntries.removeAt(oldest);
+    }
+
+    Entry entry;
+    entry.url = url;
+    entry.sequence = ++m_sequence;
+    tabEntries.append(entry);
+    return &tabEntries.last();
+}
+
+void BackForwardCache::evict()
+{
+    // Least recently stored session histories go first. The one just stored
+    // is kept even if it alone exceeds the limit.
+    while (m_size > m_maxSize && m_sessionHistoryOrder.count() > 1) {
+        m_size -= m_sessionHistories.take(m_sessionHistoryOrder.takeFirst()).size();
+    }
+}
@@ -0,0 +1,61 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BACKFORWARDCACHE_H
+#define BACKFORWARDCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+#include <QString>
+#include <QVariant>
+
+class BackForwardCache {
+
+public :
+    struct Entry {
+        Entry();
+
+        QString url;
+        QRectF contentRect;
+        // Orders entries of a tab by last use.
+        quint64 sequence;
+    };
+
+    explicit BackForwardCache(int maxSize = 4 * 1024 * 1024, int maxEntriesPerTab = 5);
+
+    void storeContentRect(int tabId, const QString &url, const QRectF &contentRect);
+    const Entry *find(int tabId, const QString &url) const;
+
+    void setSessionHistory(int tabId, const QVariant &sessionHistory);
+    QVariant sessionHistory(int tabId) const;
+
+    void remove(int tabId);
+    void clear();
+
+    int size() const;
+    int maxSize() const;
+
+private:
+    Entry *findOrCreate(int tabId, const QString &url);
+    void evict();
+
+    QHash<int, QList<Entry> > m_entries;
+    QHash<int, QByteArray> m_sessionHistories;
+    // Tabs of m_sessionHistories, least recently stored first.
+    QList<int> m_sessionHistoryOrder;
+    int m_maxSize;
+    int m_maxEntriesPerTab;
+    int m_size;
+    quint64 m_sequence;
+};
+
+#endif
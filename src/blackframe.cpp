@@ -0,0 +1,127 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "blackframe.h"
+
+#include <QImage>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BLACKFRAME_NEON
+#endif
+
+// Color channels of a 32-bit QRgb pixel.
+static const quint32 gRgbMask = 0x00ffffff;
+// Samples per dimension of the sampled check.
+static const int gSampleGridSize = 16;
+
+static bool rowBlack(const quint32 *pixels, int count)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128i mask = _mm_set1_epi32(gRgbMask);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        const __m128i *p = reinterpret_cast<const __m128i *>(pixels + i);
+        __m128i bits = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(p), _mm_loadu_si128(p + 1)),
+                                    _mm_or_si128(_mm_loadu_si128(p + 2), _mm_loadu_si128(p + 3)));
+        bits = _mm_cmpeq_epi32(_mm_and_si128(bits, mask), zero);
+        if (_mm_movemask_epi8(bits) != 0xffff) {
+            return false;
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        __m128i bits = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + i));
+        bits = _mm_cmpeq_epi32(_mm_and_si128(bits, mask), zero);
+        if (_mm_movemask_epi8(bits) != 0xffff) {
+            return false;
+        }
+    }
+#elif defined(BLACKFRAME_NEON)
+    const uint32x4_t mask = vdupq_n_u32(gRgbMask);
+    for (; i + 16 <= count; i += 16) {
+        const uint32_t *p = pixels + i;
+        uint32x4_t bits = vorrq_u32(vorrq_u32(vld1q_u32(p), vld1q_u32(p + 4)),
+                                    vorrq_u32(vld1q_u32(p + 8), vld1q_u32(p + 12)));
+        bits = vandq_u32(bits, mask);
+        uint32x2_t half = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+        if (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) {
+            return false;
+        }
+    }
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t bits = vandq_u32(vld1q_u32(pixels + i), mask);
+        uint32x2_t half = vorr_u32(vget_low_u32(bits), vget_high_u32(bits));
+        if (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) {
+            return false;
+        }
+    }
+#else
+    for (; i + 4 <= count; i += 4) {
+        if ((pixels[i] | pixels[i + 1] | pixels[i + 2] | pixels[i + 3]) & gRgbMask) {
+            return false;
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        if (pixels[i] & gRgbMask) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool samplesBlack(const QImage &image)
+{
+    int w = image.width();
+    int h = image.height();
+    int stepX = qMax(1, w / gSampleGridSize);
+    int stepY = qMax(1, h / gSampleGridSize);
+
+    for (int y = stepY / 2; y < h; y += stepY) {
+        const quint32 *line = reinterpret_cast<const quint32 *>(image.constScanLine(y));
+        for (int x = stepX / 2; x < w; x += stepX) {
+            if (line[x] & gRgbMask) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool allBlack(const QImage &image, BlackFrameCheck check)
+{
+    if (image.isNull()) {
+        return true;
+    }
+
+    // Kernels operate on QRgb pixels.
+    if (image.format() != QImage::Format_RGB32
+            && image.format() != QImage::Format_ARGB32
+            && image.format() != QImage::Format_ARGB32_Premultiplied) {
+        return allBlack(image.convertToFormat(QImage::Format_ARGB32_Premultiplied), check);
+    }
+
+    if (check == SampledCheck && !samplesBlack(image)) {
+        return false;
+    }
+
+    int h = image.height();
+    int w = image.width();
+    for (int y = 0; y < h; ++y) {
+        if (!rowBlack(reinterpret_cast<const quint32 *>(image.constScanLine(y)), w)) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,29 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef BLACKFRAME_H
+#define BLACKFRAME_H
+
+class QImage;
+
+enum BlackFrameCheck {
+    // Every pixel is tested.
+    FullCheck,
+    // A sparse grid of pixels is tested first, an image with a non-black
+    // sample is rejected without the full scan.
+    SampledCheck
+};
+
+// Returns true if color channels of all pixels of the \a image are zero.
+// Alpha channel is ignored.
+bool allBlack(const QImage &image, BlackFrameCheck check = SampledCheck);
+
+#endif // BLACKFRAME_H
@@ -11,17 +11,17 @@
 
 #include "bookmark.h"
 
-Bookmark::Bookmark(QString title, QString url, QString favicon, bool hasTouchIcon, QObject* parent)
-    : QObject(parent)
-    , m_title(title)
+Bookmark::Bookmark(QString title, QString url, QString favicon, bool hasTouchIcon)
+    : m_title(title)
     , m_url(url)
     , m_favicon(favicon)
     , m_hasTouchIcon(hasTouchIcon)
 {
-    if (m_favicon.isEmpty()) {
-        m_favicon = DEFAULT_DESKTOP_BOOKMARK_ICON;
-        m_hasTouchIcon = true;
-    }
+}
+
+Bookmark::Bookmark()
+    : m_hasTouchIcon(false)
+{
 }
 
 QString Bookmark::title() const {
@@ -29,21 +29,20 @@ QString Bookmark::title() const {
 }
 
 void Bookmark::setTitle(QString title) {
-    if(title != m_title) {
-        m_title = title;
-        emit titleChanged();
-    }
+    m_title = title;
 }
 
 QString Bookmark::url() const {
+    return m_url.toString();
+}
+
+InternedUrl Bookmark::internedUrl() const
+{
     return m_url;
 }
 
 void Bookmark::setUrl(QString url) {
-    if(url != m_url) {
-        m_url = url;
-        emit urlChanged();
-    }
+    m_url = InternedUrl(url);
 }
 
 QString Bookmark::favicon() const {
@@ -51,10 +50,7 @@ QString Bookmark::favicon() const {
 }
 
 void Bookmark::setFavicon(QString favicon) {
-    if(favicon != m_favicon) {
-        m_favicon = favicon;
-        emit faviconChanged();
-    }
+    m_favicon = favicon;
 }
 
 bool Bookmark::hasTouchIcon() const
@@ -66,3 +62,8 @@ void Bookmark::setHasTouchIcon(bool hasTouchIcon)
 {
     m_hasTouchIcon = hasTouchIcon;
 }
+
+bool Bookmark::isValid() const
+{
+    return !m_url.isEmpty();
+}
@@ -12,22 +12,25 @@
 #ifndef BOOKMARK_H
 #define BOOKMARK_H
 
-#include <QObject>
+#include <QList>
+#include <QMetaType>
+#include <QString>
 
-class Bookmark : public QObject {
-    Q_OBJECT
-
-    Q_PROPERTY(QString title READ title WRITE setTitle NOTIFY titleChanged)
-    Q_PROPERTY(QString url READ url WRITE setUrl NOTIFY urlChanged)
-    Q_PROPERTY(QString favicon READ favicon WRITE setFavicon NOTIFY faviconChanged)
+#include "internedurl.h"
 
+// Value type, passed from the database worker in queued signals and stored
+// by value in the bookmark model.
+class Bookmark
+{
 public:
-    Bookmark(QString title, QString url, QString favicon, bool hasTouchIcon, QObject* parent = 0);
+    explicit Bookmark(QString title, QString url, QString favicon, bool hasTouchIcon);
+    explicit Bookmark();
 
     QString title() const;
     void setTitle(QString title);
 
     QString url() const;
+    InternedUrl internedUrl() const;
     void setUrl(QString url);
 
     QString favicon() const;
@@ -35,16 +38,18 @@ public:
 
     bool hasTouchIcon() const;
     void setHasTouchIcon(bool hasTouchIcon);
-signals:
-    void titleChanged();
-    void urlChanged();
-    void faviconChanged();
+
+    bool isValid() const;
 
 private:
     QString m_title;
-    QString m_url;
+    InternedUrl m_url;
     QString m_favicon;
     bool m_hasTouchIcon;
 };
 
+Q_DECLARE_TYPEINFO(Bookmark, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(Bookmark)
+Q_DECLARE_METATYPE(QList<Bookmark>)
+
 #endif // BOOKMARK_H
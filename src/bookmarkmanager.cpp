@@ -11,19 +11,38 @@
 
 #include "bookmarkmanager.h"
 #include <QDebug>
-#include <QStandardPaths>
-#include <QDir>
 #include <QFile>
-#include <QTextStream>
+#include <QStandardPaths>
+#include <QStringList>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMap>
 #include <QRegularExpression>
+#include <QtConcurrent>
 
 #include "bookmark.h"
+#include "dbmanager.h"
+#include "iconstore.h"
+
+static const QString gMigratedSetting("bookmarksMigrated");
+
+// Jolla services are shown with the Jolla icon instead of their favicon.
+static bool isJollaService(const QString &url)
+{
+    static const QRegularExpression jollaUrl("^http[s]?://(together.)?jolla.com");
+    return url.contains(jollaUrl) ||
+            url.startsWith("http://m.youtube.com/playlist?list=PLQgR2jhO_J0y8YSSvVd-Mg9LM88W0aIpD");
+}
+
+static QString migrationPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json";
+}
 
 BookmarkManager::BookmarkManager()
 {
+    connect(&m_migration, SIGNAL(finished()), this, SLOT(migrationFinished()));
 }
 
 BookmarkManager* BookmarkManager::instance()
@@ -36,88 +55,116 @@ BookmarkManager* BookmarkManager::instance()
     return singleton;
 }
 
-void BookmarkManager::save(const QMap<QString, Bookmark*> & bookmarks)
+void BookmarkManager::add(const Bookmark &bookmark)
 {
-    QString settingsLocation = QStandardPaths::writableLocation(QStandardPaths::DataLocation);
-    QDir dir(settingsLocation);
-    if (!dir.exists()) {
-        if (!dir.mkpath(settingsLocation)) {
-            qWarning() << "Can't create directory " << settingsLocation;
-            return;
-        }
-    }
-    QString path = settingsLocation + "/bookmarks.json";
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qWarning() << "Can't create file " << path;
-        return;
-    }
-    QTextStream out(&file);
-    QJsonArray items;
-
-    QMapIterator<QString, Bookmark*> bookmarkIterator(bookmarks);
-    while (bookmarkIterator.hasNext()) {
-        bookmarkIterator.next();
-        QJsonObject title;
-        Bookmark* bookmark = bookmarkIterator.value();
-        title.insert("url", QJsonValue(bookmark->url()));
-        title.insert("title", QJsonValue(bookmark->title()));
-        title.insert("favicon", QJsonValue(bookmark->favicon()));
-        title.insert("hasTouchIcon", QJsonValue(bookmark->hasTouchIcon()));
-        items.append(QJsonValue(title));
+    if (isJollaService(bookmark.url())) {
+        Bookmark jollaBookmark(bookmark);
+        jollaBookmark.setFavicon("image://theme/icon-m-service-jolla");
+        DBManager::instance()->addBookmark(jollaBookmark);
+    } else {
+        DBManager::instance()->addBookmark(bookmark);
     }
-    QJsonDocument doc(items);
-    out.setCodec("UTF-8");
-    out << doc.toJson();
-    file.close();
+}
+
+void BookmarkManager::remove(const QString &url)
+{
+    DBManager::instance()->removeBookmark(url);
+}
+
+void BookmarkManager::edit(const QString &oldUrl, const Bookmark &bookmark)
+{
+    DBManager::instance()->editBookmark(oldUrl, bookmark.url(), bookmark.title());
+}
+
+void BookmarkManager::move(const QString &url, const QString &targetUrl)
+{
+    DBManager::instance()->moveBookmark(url, targetUrl);
 }
 
 void BookmarkManager::clear()
 {
-    save(QMap<QString, Bookmark*>());
+    DBManager::instance()->clearBookmarks();
     emit cleared();
 }
 
-QMap<QString, Bookmark*> BookmarkManager::load() {
-    QMap<QString, Bookmark*> bookmarks;
-    QString settingsLocation = QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json";
-    QScopedPointer<QFile> file(new QFile(settingsLocation));
+/**
+ * Requests bookmarks from the database, they arrive with
+ * DBManager::bookmarksAvailable(). Bookmarks of bookmarks.json are imported
+ * to the database first if that has not been done yet. The import runs in a
+ * worker thread, bookmarks are requested once it has finished.
+ */
+void BookmarkManager::load()
+{
+    if (m_migration.isRunning()) {
+        return;
+    }
 
+    if (DBManager::instance()->getSetting(gMigratedSetting).isEmpty()) {
+        m_migration.setFuture(QtConcurrent::run(&BookmarkManager::migrate));
+        return;
+    }
+    DBManager::instance()->getBookmarks();
+}
+
+void BookmarkManager::migrationFinished()
+{
+    if (m_migration.result()) {
+        // Files are removed only after the setting is saved, otherwise
+        // defaults would get imported again on the next start.
+        DBManager::instance()->saveSetting(gMigratedSetting, QLatin1String("true"));
+        QFile::remove(migrationPath());
+    }
+    DBManager::instance()->getBookmarks();
+}
+
+// Runs in a worker thread.
+bool BookmarkManager::migrate()
+{
+    QScopedPointer<QFile> file(new QFile(migrationPath()));
     if (!file->open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qWarning() << "Unable to open bookmarks " << settingsLocation;
+        qWarning() << "Unable to open bookmarks " << migrationPath();
 
         file.reset(new QFile(QLatin1Literal("/usr/share/sailfish-browser/content/bookmarks.json")));
         if (!file->open(QIODevice::ReadOnly | QIODevice::Text)) {
             qWarning() << "Unable to open bookmarks defaults";
-            return bookmarks;
         }
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(file->readAll());
-    if (doc.isArray()) {
-        QJsonArray array = doc.array();
-        QJsonArray::iterator i;
-        QRegularExpression jollaUrl("^http[s]?://(together.)?jolla.com");
-        for (i=array.begin(); i != array.end(); ++i) {
-            if ((*i).isObject()) {
-                QJsonObject obj = (*i).toObject();
-                QString url = obj.value("url").toString();
-                QString favicon = obj.value("favicon").toString();
-                if (url.contains(jollaUrl) ||
-                        url.startsWith("http://m.youtube.com/playlist?list=PLQgR2jhO_J0y8YSSvVd-Mg9LM88W0aIpD")) {
-                    favicon = "image://theme/icon-m-service-jolla";
-                }
-
-                Bookmark* m = new Bookmark(obj.value("title").toString(),
-                                           url,
-                                           favicon,
-                                           obj.value("hasTouchIcon").toBool());
-                bookmarks.insert(url, m);
-            }
+    QJsonArray array;
+    if (file->isOpen()) {
+        QJsonDocument doc = QJsonDocument::fromJson(file->readAll());
+        if (doc.isArray()) {
+            array = doc.array();
+        } else {
+            qWarning() << "Bookmarks.json should be an array of items";
         }
-    } else {
-        qWarning() << "Bookmarks.json should be an array of items";
     }
-    file->close();
-    return bookmarks;
+
+    // Ordered and unique by url like the bookmarks of bookmarks.json used to be.
+    QMap<QString, Bookmark> bookmarks;
+    QJsonArray::iterator i;
+    for (i=array.begin(); i != array.end(); ++i) {
+        if (!(*i).isObject()) {
+            continue;
+        }
+        QJsonObject obj = (*i).toObject();
+        QString url = obj.value("url").toString();
+        // Icons used to be stored inline as data urls.
+        QString favicon = IconStore::instance()->addDataUrl(obj.value("favicon").toString());
+        bool hasTouchIcon = obj.value("hasTouchIcon").toBool();
+        if (isJollaService(url)) {
+            favicon = "image://theme/icon-m-service-jolla";
+        } else if (favicon.isEmpty()) {
+            favicon = DEFAULT_DESKTOP_BOOKMARK_ICON;
+            hasTouchIcon = true;
+        }
+
+        bookmarks.insert(url, Bookmark(obj.value("title").toString(), url, favicon, hasTouchIcon));
+    }
+
+    if (!DBManager::instance()->importBookmarks(bookmarks.values())) {
+        qWarning() << "Failed to import bookmarks, keeping" << migrationPath();
+        return false;
+    }
+    return true;
 }
@@ -13,7 +13,7 @@
 #define BOOKMARKMANAGER_H
 
 #include <QObject>
-#include <QMap>
+#include <QFutureWatcher>
 
 class Bookmark;
 
@@ -24,16 +24,25 @@ class BookmarkManager : public QObject
 public:
     static BookmarkManager* instance();
 
-    void save(const QMap<QString, Bookmark*> & bookmarks);
+    void add(const Bookmark &bookmark);
+    void remove(const QString &url);
+    void edit(const QString &oldUrl, const Bookmark &bookmark);
+    void move(const QString &url, const QString &targetUrl);
     void clear();
-    QMap<QString, Bookmark*> load();
+    void load();
 
 signals:
     void cleared();
 
+private slots:
+    void migrationFinished();
+
 private:
     BookmarkManager();
 
+    static bool migrate();
+
+    QFutureWatcher<bool> m_migration;
 };
 
 #endif // BOOKMARKMANAGER_H
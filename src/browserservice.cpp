@@ -60,3 +60,8 @@ void BrowserService::dumpMemoryInfo(QString fileName)
 {
     emit dumpMemoryInfoRequested(fileName);
 }
+
+void BrowserService::dumpTabTrace(QString fileName)
+{
+    emit dumpTabTraceRequested(fileName);
+}
@@ -28,12 +28,14 @@ public slots:
     void cancelTransfer(int transferId);
     void restartTransfer(int transferId);
     void dumpMemoryInfo(QString fileName);
+    void dumpTabTrace(QString fileName);
 
 signals:
     void openUrlRequested(QString url);
     void cancelTransferRequested(int transferId);
     void restartTransferRequested(int transferId);
     void dumpMemoryInfoRequested(QString fileName);
+    void dumpTabTraceRequested(QString fileName);
 
 private:
     bool m_registered;
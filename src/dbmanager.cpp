@@ -30,6 +30,8 @@ DBManager::DBManager(QObject *parent)
     qRegisterMetaType<QList<Tab> >("QList<Tab>");
     qRegisterMetaType<QList<Link> >("QList<Link>");
     qRegisterMetaType<Tab>("Tab");
+    qRegisterMetaType<Bookmark>("Bookmark");
+    qRegisterMetaType<QList<Bookmark> >("QList<Bookmark>");
 
     worker = new DBWorker();
     worker->moveToThread(&workerThread);
@@ -43,6 +45,7 @@ DBManager::DBManager(QObject *parent)
     connect(worker, SIGNAL(titleChanged(int,int,QString,QString)), this, SIGNAL(titleChanged(int,int,QString,QString)));
     connect(worker, SIGNAL(thumbPathChanged(int,QString)), this, SIGNAL(thumbPathChanged(int,QString)));
     connect(worker, SIGNAL(nextLinkId(int)), this, SLOT(updateNextLinkId(int)));
+    connect(worker, SIGNAL(bookmarksAvailable(QList<Bookmark>)), this, SIGNAL(bookmarksAvailable(QList<Bookmark>)));
     workerThread.start();
 
     QMetaObject::invokeMethod(worker, "init", Qt::BlockingQueuedConnection);
@@ -153,6 +156,59 @@ void DBManager::clearHistory()
     QMetaObject::invokeMethod(worker, "clearHistory", Qt::QueuedConnection);
 }
 
+/**
+ * Sets page cache size of the database in kibibytes. Unused memory is released
+ * right away when the cache is shrunk.
+ */
+void DBManager::setCacheSize(int cacheSize)
+{
+    QMetaObject::invokeMethod(worker, "setCacheSize", Qt::QueuedConnection, Q_ARG(int, cacheSize));
+}
+
+void DBManager::addBookmark(const Bookmark &bookmark)
+{
+    QMetaObject::invokeMethod(worker, "addBookmark", Qt::QueuedConnection, Q_ARG(Bookmark, bookmark));
+}
+
+/**
+ * Adds \a bookmarks in one transaction and waits for it to finish. Returns
+ * true on success.
+ */
+bool DBManager::importBookmarks(const QList<Bookmark> &bookmarks)
+{
+    bool imported = false;
+    QMetaObject::invokeMethod(worker, "importBookmarks", Qt::BlockingQueuedConnection,
+                              Q_RETURN_ARG(bool, imported), Q_ARG(QList<Bookmark>, bookmarks));
+    return imported;
+}
+
+void DBManager::editBookmark(const QString &oldUrl, const QString &url, const QString &title)
+{
+    QMetaObject::invokeMethod(worker, "editBookmark", Qt::QueuedConnection,
+                              Q_ARG(QString, oldUrl), Q_ARG(QString, url), Q_ARG(QString, title));
+}
+
+void DBManager::removeBookmark(const QString &url)
+{
+    QMetaObject::invokeMethod(worker, "removeBookmark", Qt::QueuedConnection, Q_ARG(QString, url));
+}
+
+void DBManager::moveBookmark(const QString &url, const QString &targetUrl)
+{
+    QMetaObject::invokeMethod(worker, "moveBookmark", Qt::QueuedConnection,
+                              Q_ARG(QString, url), Q_ARG(QString, targetUrl));
+}
+
+void DBManager::getBookmarks()
+{
+    QMetaObject::invokeMethod(worker, "getBookmarks", Qt::QueuedConnection);
+}
+
+void DBManager::clearBookmarks()
+{
+    QMetaObject::invokeMethod(worker, "clearBookmarks", Qt::QueuedConnection);
+}
+
 void DBManager::getHistory(const QString &filter)
 {
     QMetaObject::invokeMethod(worker, "getHistory", Qt::QueuedConnection, Q_ARG(QString, filter));
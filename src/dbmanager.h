@@ -16,6 +16,7 @@
 #include <QMap>
 #include <QThread>
 
+#include "bookmark.h"
 #include "link.h"
 #include "tab.h"
 
@@ -53,6 +54,16 @@ public:
     int getMaxTabId();
     int nextLinkId();
 
+    void setCacheSize(int cacheSize);
+
+    void addBookmark(const Bookmark &bookmark);
+    bool importBookmarks(const QList<Bookmark> &bookmarks);
+    void editBookmark(const QString &oldUrl, const QString &url, const QString &title);
+    void removeBookmark(const QString &url);
+    void moveBookmark(const QString &url, const QString &targetUrl);
+    void getBookmarks();
+    void clearBookmarks();
+
 public slots:
     void tabListAvailable(QList<Tab> tabs);
 
@@ -65,6 +76,7 @@ signals:
     void thumbPathChanged(int tabId, QString path);
     void titleChanged(int tabId, int linkId, QString url, QString title);
     void settingsChanged();
+    void bookmarksAvailable(QList<Bookmark> bookmarks);
 
 private slots:
     void updateNextLinkId(int linkId);
@@ -36,3 +36,8 @@ void DBusAdaptor::dumpMemoryInfo(QString fileName)
 {
     m_BrowserService->dumpMemoryInfo(fileName);
 }
+
+void DBusAdaptor::dumpTabTrace(QString fileName)
+{
+    m_BrowserService->dumpTabTrace(fileName);
+}
@@ -28,6 +28,7 @@ public slots:
     void cancelTransfer(int transferId);
     void restartTransfer(int transferId);
     void dumpMemoryInfo(QString fileName);
+    void dumpTabTrace(QString fileName);
 
 private:
     BrowserService *m_BrowserService;
@@ -26,7 +26,7 @@
 #define DEBUG_LOGS 0
 #endif
 
-#define DB_USER_VERSION 1
+#define DB_USER_VERSION 2
 
 #define QUOTE(arg) #arg
 #define STR(arg) QUOTE(arg)
@@ -64,6 +64,15 @@ static const char * const create_table_settings =
         "value TEXT\n"
         ");\n";
 
+static const char * const create_table_bookmark =
+        "CREATE TABLE bookmark (bookmark_id INTEGER PRIMARY KEY AUTOINCREMENT,\n"
+        "url TEXT UNIQUE,\n"
+        "title TEXT,\n"
+        "favicon TEXT,\n"
+        "has_touch_icon INTEGER DEFAULT 0,\n"
+        "position INTEGER\n"
+        ");\n";
+
 static const char * const set_user_version =
         "PRAGMA user_version=" STR(DB_USER_VERSION) ";\n";
 
@@ -73,6 +82,7 @@ static const char *db_schema[] = {
     create_table_link,
     create_table_browser_history,
     create_table_settings,
+    create_table_bookmark,
     set_user_version
 };
 static int db_schema_count = sizeof(db_schema) / sizeof(*db_schema);
@@ -113,9 +123,12 @@ void DBWorker::init()
     QSqlQuery schemaQuery = prepare("PRAGMA user_version;");
     if (execute(schemaQuery) && schemaQuery.next()) {
         int userVersion = schemaQuery.value(0).toInt();
-        if (userVersion == 0) {
+        if (userVersion < 1) {
             migrateTo_1();
         }
+        if (userVersion < 2) {
+            migrateTo_2();
+        }
     } else {
         qWarning() << "Failed to check schema version";
     }
@@ -178,6 +191,17 @@ void DBWorker::migrateTo_1() {
     setUserVersion(1);
 }
 
+// Bookmarks used to be stored in bookmarks.json, BookmarkManager imports them to this table.
+void DBWorker::migrateTo_2()
+{
+    QSqlQuery createBookmarkTable = prepare(create_table_bookmark);
+    if (!execute(createBookmarkTable)) {
+        qCritical() << "Failed to create bookmark table";
+    }
+
+    setUserVersion(2);
+}
+
 QSqlQuery DBWorker::prepare(const QString &statement)
 {
     QSqlQuery query(m_database);
@@ -586,6 +610,150 @@ void DBWorker::clearHistory()
     }
 }
 
+void DBWorker::setCacheSize(int cacheSize)
+{
+    // Negative cache_size is interpreted as kibibytes.
+    QSqlQuery query = prepare(QString("PRAGMA cache_size = -%1;").arg(cacheSize));
+    execute(query);
+    query = prepare("PRAGMA shrink_memory;");
+    execute(query);
+}
+
+/**
+ * Adds \a bookmark as the last one, or updates an earlier bookmark of the same
+ * url in place.
+ */
+void DBWorker::addBookmark(Bookmark bookmark)
+{
+    insertBookmark(bookmark);
+}
+
+/**
+ * Adds all \a bookmarks in one transaction. Returns false if nothing was added.
+ */
+bool DBWorker::importBookmarks(QList<Bookmark> bookmarks)
+{
+    m_database.transaction();
+    for (int i = 0; i < bookmarks.count(); ++i) {
+        if (!insertBookmark(bookmarks.at(i))) {
+            m_database.rollback();
+            return false;
+        }
+    }
+    return m_database.commit();
+}
+
+void DBWorker::editBookmark(QString oldUrl, QString url, QString title)
+{
+    QSqlQuery query = prepare("UPDATE bookmark SET url = ?, title = ? WHERE url = ?;");
+    query.bindValue(0, url);
+    query.bindValue(1, title);
+    query.bindValue(2, oldUrl);
+    execute(query);
+}
+
+void DBWorker::removeBookmark(QString url)
+{
+    int position = bookmarkPosition(url);
+    if (position < 0) {
+        return;
+    }
+
+    m_database.transaction();
+    QSqlQuery query = prepare("DELETE FROM bookmark WHERE url = ?;");
+    query.bindValue(0, url);
+    // Keep positions contiguous.
+    QSqlQuery positionQuery = prepare("UPDATE bookmark SET position = position - 1 WHERE position > ?;");
+    positionQuery.bindValue(0, position);
+    if (execute(query) && execute(positionQuery)) {
+        m_database.commit();
+    } else {
+        m_database.rollback();
+    }
+}
+
+/**
+ * Moves bookmark of \a url to the position of the bookmark of \a targetUrl,
+ * shifting the bookmarks in between by one.
+ */
+void DBWorker::moveBookmark(QString url, QString targetUrl)
+{
+    int from = bookmarkPosition(url);
+    int to = bookmarkPosition(targetUrl);
+    if (from < 0 || to < 0 || from == to) {
+        return;
+    }
+
+    m_database.transaction();
+    QSqlQuery shiftQuery = from < to
+            ? prepare("UPDATE bookmark SET position = position - 1 WHERE position > ? AND position <= ?;")
+            : prepare("UPDATE bookmark SET position = position + 1 WHERE position >= ? AND position < ?;");
+    shiftQuery.bindValue(0, qMin(from, to));
+    shiftQuery.bindValue(1, qMax(from, to));
+    QSqlQuery query = prepare("UPDATE bookmark SET position = ? WHERE url = ?;");
+    query.bindValue(0, to);
+    query.bindValue(1, url);
+    if (execute(shiftQuery) && execute(query)) {
+        m_database.commit();
+    } else {
+        m_database.rollback();
+    }
+}
+
+void DBWorker::getBookmarks()
+{
+    QSqlQuery query = prepare("SELECT url, title, favicon, has_touch_icon FROM bookmark ORDER BY position;");
+    if (!execute(query)) {
+        return;
+    }
+
+    QList<Bookmark> bookmarks;
+    while (query.next()) {
+        bookmarks.append(Bookmark(query.value(1).toString(), query.value(0).toString(),
+                                  query.value(2).toString(), query.value(3).toBool()));
+    }
+    emit bookmarksAvailable(bookmarks);
+}
+
+void DBWorker::clearBookmarks()
+{
+    QSqlQuery query = prepare("DELETE FROM bookmark;");
+    execute(query);
+}
+
+bool DBWorker::insertBookmark(const Bookmark &bookmark)
+{
+    QSqlQuery query = prepare("UPDATE bookmark SET title = ?, favicon = ?, has_touch_icon = ? "
+                              "WHERE url = ?;");
+    query.bindValue(0, bookmark.title());
+    query.bindValue(1, bookmark.favicon());
+    query.bindValue(2, bookmark.hasTouchIcon());
+    query.bindValue(3, bookmark.url());
+    if (!execute(query)) {
+        return false;
+    } else if (query.numRowsAffected() > 0) {
+        return true;
+    }
+
+    query = prepare("INSERT INTO bookmark (url, title, favicon, has_touch_icon, position) "
+                    "VALUES (?, ?, ?, ?, (SELECT COUNT(*) FROM bookmark));");
+    query.bindValue(0, bookmark.url());
+    query.bindValue(1, bookmark.title());
+    query.bindValue(2, bookmark.favicon());
+    query.bindValue(3, bookmark.hasTouchIcon());
+    return execute(query);
+}
+
+int DBWorker::bookmarkPosition(const QString &url)
+{
+    QSqlQuery query = prepare("SELECT position FROM bookmark WHERE url = ?;");
+    query.bindValue(0, url);
+    if (execute(query) && query.first()) {
+        return query.value(0).toInt();
+    }
+    return -1;
+}
+
 int DBWorker::addToTabHistory(int tabId, int linkId)
 {
     QSqlQuery query = prepare("INSERT INTO tab_history (tab_id, link_id, date) VALUES (?, ?, ?);");
@@ -17,6 +17,7 @@
 #include <QSqlDatabase>
 #include <QSqlQuery>
 
+#include "bookmark.h"
 #include "link.h"
 #include "tab.h"
 
@@ -60,6 +61,16 @@ public slots:
     SettingsMap getSettings();
     void deleteSetting(QString name);
 
+    void setCacheSize(int cacheSize);
+
+    void addBookmark(Bookmark bookmark);
+    bool importBookmarks(QList<Bookmark> bookmarks);
+    void editBookmark(QString oldUrl, QString url, QString title);
+    void removeBookmark(QString url);
+    void moveBookmark(QString url, QString targetUrl);
+    void getBookmarks();
+    void clearBookmarks();
+
 signals:
     void tabAvailable(Tab tab);
     void tabChanged(Tab tab);
@@ -70,6 +81,7 @@ signals:
     void historyAvailable(QList<Link>);
     void error(QString query);
     void nextLinkId(int linkId);
+    void bookmarksAvailable(QList<Bookmark> bookmarks);
 
 private:
     Link getLink(int linkId);
@@ -87,7 +99,10 @@ private:
     Tab getTabData(int tabId, int historyId = 0);
     int tabCount();
     int integerQuery(const QString &statement);
+    bool insertBookmark(const Bookmark &bookmark);
+    int bookmarkPosition(const QString &url);
     void migrateTo_1();
+    void migrateTo_2();
     void setUserVersion(int userVersion);
 
     QSqlQuery prepare(const QString &statement);
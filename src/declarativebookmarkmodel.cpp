@@ -11,13 +11,23 @@
 
 #include "declarativebookmarkmodel.h"
 #include "bookmarkmanager.h"
+#include "dbmanager.h"
+#include "iconstore.h"
+
+// Rows inserted per event loop iteration while populating an empty model.
+static const int gBatchSize = 50;
 
 DeclarativeBookmarkModel::DeclarativeBookmarkModel(QObject *parent) :
-    QAbstractListModel(parent)
+    KeyedListModel<Bookmark>(parent),
+    m_loading(true)
 {
+    m_batchTimer.setSingleShot(true);
+    m_batchTimer.setInterval(0);
+    connect(&m_batchTimer, SIGNAL(timeout()), this, SLOT(insertBatch()));
     connect(BookmarkManager::instance(), SIGNAL(cleared()), this, SLOT(clearBookmarks()));
-    bookmarks = BookmarkManager::instance()->load();
-    bookmarkUrls = bookmarks.keys();
+    connect(DBManager::instance(), SIGNAL(bookmarksAvailable(QList<Bookmark>)),
+            this, SLOT(bookmarksAvailable(QList<Bookmark>)));
+    BookmarkManager::instance()->load();
 }
 
 QHash<int, QByteArray> DeclarativeBookmarkModel::roleNames() const
@@ -32,98 +42,194 @@ QHash<int, QByteArray> DeclarativeBookmarkModel::roleNames() const
 
 void DeclarativeBookmarkModel::addBookmark(const QString& url, const QString& title, const QString& favicon, bool touchIcon)
 {
-    beginInsertRows(QModelIndex(), rowCount(), rowCount());
-    bookmarks.insert(url, new Bookmark(title, url, favicon, touchIcon));
-    bookmarkUrls.append(url);
-    endInsertRows();
+    QString icon = IconStore::instance()->addDataUrl(favicon);
+    if (icon.isEmpty()) {
+        icon = DEFAULT_DESKTOP_BOOKMARK_ICON;
+        touchIcon = true;
+    }
 
-    emit countChanged();
-    save();
+    Bookmark bookmark(title, url, icon, touchIcon);
+    int index = row(bookmark.internedUrl());
+    if (index >= 0) {
+        // Bookmarking an url again updates the bookmark in place.
+        replaceItem(index, bookmark);
+    } else {
+        appendItem(bookmark);
+        emit countChanged();
+    }
+    BookmarkManager::instance()->add(bookmark);
 }
 
 void DeclarativeBookmarkModel::removeBookmark(const QString& url)
 {
-    if (!contains(url)) {
+    int index = row(InternedUrl::find(url));
+    if (index < 0) {
         return;
     }
 
-    if (bookmarks.contains(url)) {
-        int index = bookmarkUrls.indexOf(url);
-        beginRemoveRows(QModelIndex(), index, index);
-        Bookmark* bookmark = bookmarks.take(url);
-        delete bookmark;
-        bookmarkUrls.removeAt(index);
-        endRemoveRows();
+    removeItem(index);
+    emit countChanged();
+    BookmarkManager::instance()->remove(url);
+}
 
-        emit countChanged();
-        save();
+void DeclarativeBookmarkModel::editBookmark(int index, const QString& url, const QString& title)
+{
+    if (index < 0 || index >= m_items.count())
+        return;
+
+    Bookmark bookmark = m_items.at(index);
+    QString oldUrl = bookmark.url();
+    // Url of another bookmark cannot be taken over.
+    if (url != oldUrl && row(InternedUrl::find(url)) < 0) {
+        bookmark.setUrl(url);
+    }
+    bookmark.setTitle(title);
+
+    if (!changedRoles(m_items.at(index), bookmark).isEmpty()) {
+        replaceItem(index, bookmark);
+        BookmarkManager::instance()->edit(oldUrl, bookmark);
     }
 }
 
-void DeclarativeBookmarkModel::editBookmark(int index, const QString& url, const QString& title)
+/**
+ * Moves the bookmark at \a from to \a to. The order is kept in the database.
+ * Rows need not match database positions, e.g. a bookmark added while loading
+ * is last in the database, hence the move refers to the bookmark at \a to.
+ */
+void DeclarativeBookmarkModel::moveBookmark(int from, int to)
 {
-    if (index < 0 || index > bookmarkUrls.count())
+    if (from < 0 || from >= m_items.count() || to < 0 || to >= m_items.count() || from == to)
         return;
 
-    Bookmark * bookmark = bookmarks.value(bookmarkUrls[index]);
-    QVector<int> roles;
-    if (url != bookmark->url()) {
-        bookmark->setUrl(url);
-        bookmarks.remove(bookmarkUrls[index]);
-        bookmarks.insert(url, bookmark);
-        bookmarkUrls[index] = url;
-        roles << UrlRole;
+    QString url = m_items.at(from).url();
+    QString targetUrl = m_items.at(to).url();
+    moveItem(from, to);
+    BookmarkManager::instance()->move(url, targetUrl);
+}
+
+/**
+ * Populates an empty model in batches of gBatchSize rows so that the first
+ * rows get shown without waiting for the rest. Otherwise the model is updated
+ * to match \a bookmarkList in one go.
+ */
+void DeclarativeBookmarkModel::bookmarksAvailable(QList<Bookmark> bookmarkList)
+{
+    if (m_items.isEmpty() && m_pendingBookmarks.isEmpty()) {
+        m_pendingBookmarks = bookmarkList;
+        setLoading(true);
+        insertBatch();
+        return;
     }
-    if (title != bookmark->title()) {
-        bookmark->setTitle(title);
-        roles << TitleRole;
+
+    // Keep bookmarks that got added before the database replied.
+    QSet<InternedUrl> urls;
+    for (int i = 0; i < bookmarkList.count(); ++i) {
+        urls.insert(bookmarkList.at(i).internedUrl());
+    }
+    for (int i = 0; i < m_items.count(); ++i) {
+        if (!urls.contains(m_items.at(i).internedUrl())) {
+            bookmarkList.append(m_items.at(i));
+        }
+    }
+
+    m_pendingBookmarks.clear();
+    m_batchTimer.stop();
+    int oldCount = m_items.count();
+    setItems(bookmarkList);
+    if (oldCount != m_items.count()) {
+        emit countChanged();
     }
-    if (roles.count() > 0) {
-        QModelIndex modelIndex = QAbstractListModel::index(index);
-        emit dataChanged(modelIndex, modelIndex, roles);
-        save();
+    setLoading(false);
+}
+
+void DeclarativeBookmarkModel::insertBatch()
+{
+    QList<Bookmark> batch;
+    while (!m_pendingBookmarks.isEmpty() && batch.count() < gBatchSize) {
+        Bookmark bookmark = m_pendingBookmarks.takeFirst();
+        // Skip bookmarks that got added while loading.
+        if (row(bookmark.internedUrl()) < 0) {
+            batch.append(bookmark);
+        }
+    }
+
+    if (!batch.isEmpty()) {
+        appendItems(batch);
+        emit countChanged();
+    }
+
+    if (m_pendingBookmarks.isEmpty()) {
+        setLoading(false);
+    } else {
+        m_batchTimer.start();
     }
 }
 
 void DeclarativeBookmarkModel::clearBookmarks()
 {
-    beginRemoveRows(QModelIndex(), 0, bookmarkUrls.count()-1);
-    bookmarks.clear();
-    bookmarkUrls.clear();
-    endRemoveRows();
+    m_pendingBookmarks.clear();
+    m_batchTimer.stop();
+    clearItems();
     emit countChanged();
+    setLoading(false);
 }
 
-void DeclarativeBookmarkModel::save()
+bool DeclarativeBookmarkModel::loading() const
 {
-    BookmarkManager::instance()->save(bookmarks);
+    return m_loading;
+}
+
+void DeclarativeBookmarkModel::setLoading(bool loading)
+{
+    if (m_loading != loading) {
+        m_loading = loading;
+        emit loadingChanged();
+    }
 }
 
 int DeclarativeBookmarkModel::rowCount(const QModelIndex & parent) const
 {
     Q_UNUSED(parent)
-    return bookmarks.count();
+    return m_items.count();
 }
 
 QVariant DeclarativeBookmarkModel::data(const QModelIndex & index, int role) const
 {
-    if (index.row() < 0 || index.row() > bookmarkUrls.count())
+    if (index.row() < 0 || index.row() >= m_items.count())
         return QVariant();
 
-    const Bookmark * bookmark = bookmarks.value(bookmarkUrls[index.row()]);
+    const Bookmark &bookmark = m_items.at(index.row());
     if (role == UrlRole) {
-        return bookmark->url();
+        return bookmark.url();
     } else if (role == TitleRole) {
-        return bookmark->title();
+        return bookmark.title();
     } else if (role == FaviconRole) {
-        return bookmark->favicon();
+        return bookmark.favicon();
     } else if (role == TouchIconRole) {
-        return bookmark->hasTouchIcon();
+        return bookmark.hasTouchIcon();
     }
     return QVariant();
 }
 
 bool DeclarativeBookmarkModel::contains(const QString& url) const
 {
-    return bookmarks.contains(url);
+    return row(InternedUrl::find(url)) >= 0;
+}
+
+QVector<int> DeclarativeBookmarkModel::changedRoles(const Bookmark &oldBookmark, const Bookmark &newBookmark) const
+{
+    QVector<int> roles;
+    if (oldBookmark.internedUrl() != newBookmark.internedUrl()) {
+        roles << UrlRole;
+    }
+    if (oldBookmark.title() != newBookmark.title()) {
+        roles << TitleRole;
+    }
+    if (oldBookmark.favicon() != newBookmark.favicon()) {
+        roles << FaviconRole;
+    }
+    if (oldBookmark.hasTouchIcon() != newBookmark.hasTouchIcon()) {
+        roles << TouchIconRole;
+    }
+    return roles;
 }
@@ -12,16 +12,16 @@
 #ifndef DECLARATIVEBOOKMARKMODEL_H
 #define DECLARATIVEBOOKMARKMODEL_H
 
-#include <QAbstractListModel>
-#include <QStringList>
-#include <QMap>
+#include <QTimer>
 
 #include "bookmark.h"
+#include "keyedlistmodel.h"
 
-class DeclarativeBookmarkModel : public QAbstractListModel
+class DeclarativeBookmarkModel : public KeyedListModel<Bookmark>
 {
     Q_OBJECT
     Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool loading READ loading NOTIFY loadingChanged)
 public:
     DeclarativeBookmarkModel(QObject *parent = 0);
     
@@ -36,6 +36,9 @@ public:
     Q_INVOKABLE void removeBookmark(const QString& url);
     Q_INVOKABLE bool contains(const QString& url) const;
     Q_INVOKABLE void editBookmark(int index, const QString& url, const QString& title);
+    Q_INVOKABLE void moveBookmark(int from, int to);
+
+    bool loading() const;
 
     // From QAbstractListModel
     int rowCount(const QModelIndex & parent = QModelIndex()) const;
@@ -43,15 +46,23 @@ public:
     QHash<int, QByteArray> roleNames() const;
 
 private slots:
+    void bookmarksAvailable(QList<Bookmark> bookmarkList);
     void clearBookmarks();
+    void insertBatch();
 
 signals:
     void countChanged();
+    void loadingChanged();
+
+protected:
+    QVector<int> changedRoles(const Bookmark &oldBookmark, const Bookmark &newBookmark) const;
 
 private:
-    void save();
+    void setLoading(bool loading);
 
-    QMap<QString, Bookmark*> bookmarks;
-    QStringList bookmarkUrls;
+    // Loaded bookmarks not inserted to the model yet.
+    QList<Bookmark> m_pendingBookmarks;
+    QTimer m_batchTimer;
+    bool m_loading;
 };
 #endif // DECLARATIVEBOOKMARKMODEL_H
@@ -14,7 +14,7 @@
 #include "dbmanager.h"
 
 DeclarativeHistoryModel::DeclarativeHistoryModel(QObject *parent)
-    : QAbstractListModel(parent)
+    : KeyedListModel<Link>(parent)
 {
     connect(DBManager::instance(), SIGNAL(historyAvailable(QList<Link>)),
             this, SLOT(historyAvailable(QList<Link>)));
@@ -32,9 +32,7 @@ QHash<int, QByteArray> DeclarativeHistoryModel::roleNames() const
 
 void DeclarativeHistoryModel::clear()
 {
-    beginResetModel();
-    m_links.clear();
-    endResetModel();
+    clearItems();
     DBManager::instance()->clearHistory();
     emit countChanged();
 }
@@ -46,14 +44,14 @@ void DeclarativeHistoryModel::search(const QString &filter)
 
 int DeclarativeHistoryModel::rowCount(const QModelIndex & parent) const {
     Q_UNUSED(parent);
-    return m_links.count();
+    return m_items.count();
 }
 
 QVariant DeclarativeHistoryModel::data(const QModelIndex & index, int role) const {
-    if (index.row() < 0 || index.row() > m_links.count())
+    if (index.row() < 0 || index.row() > m_items.count())
         return QVariant();
 
-    const Link url = m_links[index.row()];
+    const Link url = m_items[index.row()];
     if (role == UrlRole) {
         return url.url();
     } else if (role == TitleRole) {
@@ -80,52 +78,31 @@ void DeclarativeHistoryModel::historyAvailable(QList<Link> linkList)
 
 void DeclarativeHistoryModel::updateModel(QList<Link> linkList)
 {
-    int i = 0;
-    int startIndex = -1;
-    for (i = 0; i < linkList.count() && i < m_links.count(); i++) {
-        if (m_links.at(i) != linkList.at(i)) {
-            m_links[i] = linkList.at(i);
-            if (startIndex < 0) {
-                startIndex = i;
-            }
-        } else if (startIndex >= 0) {
-            emit dataChanged(index(startIndex), index(i-1));
-            startIndex = -1;
-        }
-    }
-
-    if (startIndex >= 0) {
-        emit dataChanged(index(startIndex), index(m_links.count()-1));
+    int oldCount = m_items.count();
+    setItems(linkList);
+    if (oldCount != m_items.count()) {
+        emit countChanged();
     }
+}
 
-    int difference = linkList.count() - m_links.count();
-    if (difference != 0) {
-        if (difference < 0) {
-            beginRemoveRows(QModelIndex(), linkList.count(), m_links.count()-1);
-            m_links.erase(m_links.begin()+linkList.count(), m_links.end());
-            endRemoveRows();
-        } else {
-            beginInsertRows(QModelIndex(), m_links.count(), linkList.count()-1);
-            m_links.append(linkList.mid(m_links.count()));
-            endInsertRows();
-        }
-
-        emit countChanged();
+QVector<int> DeclarativeHistoryModel::changedRoles(const Link &oldLink, const Link &newLink) const
+{
+    QVector<int> roles;
+    if (oldLink.title() != newLink.title()) {
+        roles << TitleRole;
     }
+    return roles;
 }
 
 void DeclarativeHistoryModel::updateTitle(int tabId, int linkId, QString url, QString title)
 {
     Q_UNUSED(tabId);
     Q_UNUSED(linkId);
-    QVector<int> roles;
-    roles << TitleRole;
-    for (int i = 0; i < m_links.count(); i++) {
-        if (m_links.at(i).url() == url && m_links.at(i).title() != title) {
-            m_links[i].setTitle(title);
-            QModelIndex start = index(i, 0);
-            QModelIndex end = index(i, 0);
-            emit dataChanged(start, end, roles);
-        }
+    int row = this->row(InternedUrl::find(url));
+    if (row >= 0 && m_items.at(row).title() != title) {
+        m_items[row].setTitle(title);
+        QVector<int> roles;
+        roles << TitleRole;
+        emit dataChanged(index(row), index(row), roles);
     }
 }
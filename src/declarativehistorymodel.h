@@ -12,13 +12,13 @@
 #ifndef DECLARATIVEHISTORYMODEL_H
 #define DECLARATIVEHISTORYMODEL_H
 
-#include <QAbstractListModel>
 #include <QQmlParserStatus>
 
+#include "keyedlistmodel.h"
 #include "tab.h"
 #include "link.h"
 
-class DeclarativeHistoryModel : public QAbstractListModel, public QQmlParserStatus
+class DeclarativeHistoryModel : public KeyedListModel<Link>, public QQmlParserStatus
 {
     Q_OBJECT
     Q_INTERFACES(QQmlParserStatus)
@@ -51,11 +51,12 @@ private slots:
     void historyAvailable(QList<Link> linkList);
     void updateTitle(int tabId, int linkId, QString url, QString title);
 
+protected:
+    QVector<int> changedRoles(const Link &oldLink, const Link &newLink) const;
+
 private:
     void updateModel(QList<Link> linkList);
 
-    QList<Link> m_links;
-
     friend class tst_declarativehistorymodel;
     friend class tst_webview;
 };
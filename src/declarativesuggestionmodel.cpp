@@ -0,0 +1,272 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "declarativesuggestionmodel.h"
+
+#include <QDebug>
+#include <QMetaObject>
+
+#ifndef DEBUG_LOGS
+#define DEBUG_LOGS 0
+#endif
+
+// Default time one keystroke may spend in matching, in milliseconds.
+static const int gDefaultLatencyBudget = 50;
+
+static int roleByName(const QHash<int, QByteArray> &roleNames, const QByteArray &name)
+{
+    return roleNames.key(name, -1);
+}
+
+DeclarativeSuggestionModel::DeclarativeSuggestionModel(QObject *parent)
+    : KeyedListModel<Suggestion>(parent)
+    , m_engine(new SuggestionEngine)
+    , m_tabsChanged(false)
+    , m_bookmarksChanged(false)
+    , m_queryId(0)
+    , m_latencyBudget(gDefaultLatencyBudget)
+    , m_partial(false)
+{
+    qRegisterMetaType<QList<Suggestion> >("QList<Suggestion>");
+
+    m_engine->moveToThread(&m_workerThread);
+    connect(&m_workerThread, SIGNAL(finished()), m_engine, SLOT(deleteLater()));
+    connect(m_engine, SIGNAL(suggestionsAvailable(int,QList<Suggestion>,bool)),
+            this, SLOT(suggestionsAvailable(int,QList<Suggestion>,bool)));
+    m_workerThread.start();
+}
+
+DeclarativeSuggestionModel::~DeclarativeSuggestionModel()
+{
+    // Abandon a query that might be running.
+    m_engine->supersede(-1);
+    m_workerThread.quit();
+    m_workerThread.wait();
+}
+
+QHash<int, QByteArray> DeclarativeSuggestionModel::roleNames() const
+{
+    QHash<int, QByteArray> roles;
+    roles[UrlRole] = "url";
+    roles[TitleRole] = "title";
+    roles[SourceRole] = "source";
+    roles[TabIdRole] = "tabId";
+    return roles;
+}
+
+/**
+ * Starts matching \a filter against open tabs, bookmarks and history. The model
+ * is updated once the results are available. Results of an earlier search that
+ * have not arrived yet are dropped.
+ */
+void DeclarativeSuggestionModel::search(const QString &filter)
+{
+    // Snapshots are taken lazily so that changes of the source models
+    // cost nothing while the user is not typing.
+    if (m_tabsChanged) {
+        m_tabsChanged = false;
+        QMetaObject::invokeMethod(m_engine, "setTabs", Qt::QueuedConnection,
+                                  Q_ARG(QList<Suggestion>, snapshot(m_tabModel, Suggestion::TabSource)));
+    }
+
+    if (m_bookmarksChanged) {
+        m_bookmarksChanged = false;
+        QMetaObject::invokeMethod(m_engine, "setBookmarks", Qt::QueuedConnection,
+                                  Q_ARG(QList<Suggestion>, snapshot(m_bookmarkModel, Suggestion::BookmarkSource)));
+    }
+
+    ++m_queryId;
+    m_engine->supersede(m_queryId);
+    QMetaObject::invokeMethod(m_engine, "query", Qt::QueuedConnection,
+                              Q_ARG(int, m_queryId), Q_ARG(QString, filter), Q_ARG(int, m_latencyBudget));
+}
+
+bool DeclarativeSuggestionModel::partial() const
+{
+    return m_partial;
+}
+
+QString DeclarativeSuggestionModel::topUrl() const
+{
+    return m_topUrl;
+}
+
+int DeclarativeSuggestionModel::latencyBudget() const
+{
+    return m_latencyBudget;
+}
+
+void DeclarativeSuggestionModel::setLatencyBudget(int latencyBudget)
+{
+    if (m_latencyBudget != latencyBudget) {
+        m_latencyBudget = latencyBudget;
+        emit latencyBudgetChanged();
+    }
+}
+
+QAbstractItemModel *DeclarativeSuggestionModel::tabModel() const
+{
+    return m_tabModel;
+}
+
+void DeclarativeSuggestionModel::setTabModel(QAbstractItemModel *tabModel)
+{
+    if (m_tabModel != tabModel) {
+        unwatch(m_tabModel);
+        m_tabModel = tabModel;
+        watch(m_tabModel, SLOT(invalidateTabs()));
+        invalidateTabs();
+        emit tabModelChanged();
+    }
+}
+
+QAbstractItemModel *DeclarativeSuggestionModel::bookmarkModel() const
+{
+    return m_bookmarkModel;
+}
+
+void DeclarativeSuggestionModel::setBookmarkModel(QAbstractItemModel *bookmarkModel)
+{
+    if (m_bookmarkModel != bookmarkModel) {
+        unwatch(m_bookmarkModel);
+        m_bookmarkModel = bookmarkModel;
+        watch(m_bookmarkModel, SLOT(invalidateBookmarks()));
+        invalidateBookmarks();
+        emit bookmarkModelChanged();
+    }
+}
+
+int DeclarativeSuggestionModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return m_items.count();
+}
+
+QVariant DeclarativeSuggestionModel::data(const QModelIndex &index, int role) const
+{
+    if (index.row() < 0 || index.row() >= m_items.count())
+        return QVariant();
+
+    const Suggestion &suggestion = m_items.at(index.row());
+    if (role == UrlRole) {
+        return suggestion.url.toString();
+    } else if (role == TitleRole) {
+        return suggestion.title;
+    } else if (role == SourceRole) {
+        return suggestion.source;
+    } else if (role == TabIdRole) {
+        return suggestion.tabId;
+    }
+    return QVariant();
+}
+
+QVector<int> DeclarativeSuggestionModel::changedRoles(const Suggestion &oldSuggestion, const Suggestion &newSuggestion) const
+{
+    QVector<int> roles;
+    if (oldSuggestion.title != newSuggestion.title) {
+        roles << TitleRole;
+    }
+    if (oldSuggestion.source != newSuggestion.source) {
+        roles << SourceRole;
+    }
+    if (oldSuggestion.tabId != newSuggestion.tabId) {
+        roles << TabIdRole;
+    }
+    return roles;
+}
+
+void DeclarativeSuggestionModel::invalidateTabs()
+{
+    m_tabsChanged = true;
+}
+
+void DeclarativeSuggestionModel::invalidateBookmarks()
+{
+    m_bookmarksChanged = true;
+}
+
+void DeclarativeSuggestionModel::suggestionsAvailable(int queryId, QList<Suggestion> suggestions, bool partial)
+{
+    if (queryId != m_queryId) {
+        return;
+    }
+
+    int oldCount = m_items.count();
+    setItems(suggestions);
+    if (oldCount != m_items.count()) {
+        emit countChanged();
+    }
+
+    if (m_partial != partial) {
+        m_partial = partial;
+        emit partialChanged();
+    }
+
+    QString topUrl = m_items.isEmpty() ? QString() : m_items.first().url.toString();
+    if (m_topUrl != topUrl) {
+        m_topUrl = topUrl;
+        emit topUrlChanged();
+    }
+}
+
+void DeclarativeSuggestionModel::watch(QAbstractItemModel *model, const char *slot)
+{
+    if (!model) {
+        return;
+    }
+
+    connect(model, SIGNAL(rowsInserted(QModelIndex,int,int)), this, slot);
+    connect(model, SIGNAL(rowsRemoved(QModelIndex,int,int)), this, slot);
+    connect(model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)), this, slot);
+    connect(model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)), this, slot);
+    connect(model, SIGNAL(layoutChanged()), this, slot);
+    connect(model, SIGNAL(modelReset()), this, slot);
+    connect(model, SIGNAL(destroyed()), this, slot);
+}
+
+void DeclarativeSuggestionModel::unwatch(QAbstractItemModel *model)
+{
+    if (model) {
+        disconnect(model, 0, this, 0);
+    }
+}
+
+/**
+ * Copies url, title and tab id roles of all rows of \a model. Roles are looked up
+ * by name so that any model with "url" and "title" roles can serve as a source.
+ */
+QList<Suggestion> DeclarativeSuggestionModel::snapshot(QAbstractItemModel *model, Suggestion::Source source) const
+{
+    QList<Suggestion> suggestions;
+    if (!model) {
+        return suggestions;
+    }
+
+    QHash<int, QByteArray> roleNames = model->roleNames();
+    int urlRole = roleByName(roleNames, "url");
+    int titleRole = roleByName(roleNames, "title");
+    int tabIdRole = roleByName(roleNames, "tabId");
+    if (urlRole < 0) {
+        qWarning() << "Suggestion source has no url role" << model;
+        return suggestions;
+    }
+
+    int count = model->rowCount();
+    suggestions.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QModelIndex index = model->index(i, 0);
+        suggestions.append(Suggestion(source,
+                                      model->data(index, urlRole).toString(),
+                                      titleRole >= 0 ? model->data(index, titleRole).toString() : QString(),
+                                      tabIdRole >= 0 ? model->data(index, tabIdRole).toInt() : 0));
+    }
+    return suggestions;
+}
@@ -0,0 +1,104 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef DECLARATIVESUGGESTIONMODEL_H
+#define DECLARATIVESUGGESTIONMODEL_H
+
+#include <QPointer>
+#include <QThread>
+
+#include "keyedlistmodel.h"
+#include "suggestionengine.h"
+
+class DeclarativeSuggestionModel : public KeyedListModel<Suggestion>
+{
+    Q_OBJECT
+    Q_ENUMS(Source)
+
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+    Q_PROPERTY(bool partial READ partial NOTIFY partialChanged)
+    Q_PROPERTY(QString topUrl READ topUrl NOTIFY topUrlChanged)
+    Q_PROPERTY(int latencyBudget READ latencyBudget WRITE setLatencyBudget NOTIFY latencyBudgetChanged)
+    Q_PROPERTY(QAbstractItemModel *tabModel READ tabModel WRITE setTabModel NOTIFY tabModelChanged)
+    Q_PROPERTY(QAbstractItemModel *bookmarkModel READ bookmarkModel WRITE setBookmarkModel NOTIFY bookmarkModelChanged)
+
+public:
+    DeclarativeSuggestionModel(QObject *parent = 0);
+    ~DeclarativeSuggestionModel();
+
+    enum SuggestionRoles {
+        UrlRole = Qt::UserRole + 1,
+        TitleRole,
+        SourceRole,
+        TabIdRole
+    };
+
+    enum Source {
+        TabSource = Suggestion::TabSource,
+        BookmarkSource = Suggestion::BookmarkSource,
+        HistorySource = Suggestion::HistorySource
+    };
+
+    Q_INVOKABLE void search(const QString &filter);
+
+    bool partial() const;
+    QString topUrl() const;
+
+    int latencyBudget() const;
+    void setLatencyBudget(int latencyBudget);
+
+    QAbstractItemModel *tabModel() const;
+    void setTabModel(QAbstractItemModel *tabModel);
+
+    QAbstractItemModel *bookmarkModel() const;
+    void setBookmarkModel(QAbstractItemModel *bookmarkModel);
+
+    // From QAbstractListModel
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QHash<int, QByteArray> roleNames() const;
+
+signals:
+    void countChanged();
+    void partialChanged();
+    void topUrlChanged();
+    void latencyBudgetChanged();
+    void tabModelChanged();
+    void bookmarkModelChanged();
+
+protected:
+    QVector<int> changedRoles(const Suggestion &oldSuggestion, const Suggestion &newSuggestion) const;
+
+private slots:
+    void invalidateTabs();
+    void invalidateBookmarks();
+    void suggestionsAvailable(int queryId, QList<Suggestion> suggestions, bool partial);
+
+private:
+    void watch(QAbstractItemModel *model, const char *slot);
+    void unwatch(QAbstractItemModel *model);
+    QList<Suggestion> snapshot(QAbstractItemModel *model, Suggestion::Source source) const;
+
+    QThread m_workerThread;
+    SuggestionEngine *m_engine;
+    QPointer<QAbstractItemModel> m_tabModel;
+    QPointer<QAbstractItemModel> m_bookmarkModel;
+    bool m_tabsChanged;
+    bool m_bookmarksChanged;
+    int m_queryId;
+    int m_latencyBudget;
+    bool m_partial;
+    QString m_topUrl;
+
+    friend class tst_suggestionengine;
+};
+
+#endif // DECLARATIVESUGGESTIONMODEL_H
@@ -14,8 +14,8 @@
 #include "dbmanager.h"
 #include "linkvalidator.h"
 #include "declarativewebutils.h"
+#include "thumbnailcache.h"
 
-#include <QFile>
 #include <QDebug>
 #include <QStringList>
 #include <QUrl>
@@ -49,6 +49,7 @@ QHash<int, QByteArray> DeclarativeTabModel::roleNames() const
     roles[TitleRole] = "title";
     roles[UrlRole] = "url";
     roles[TabIdRole] = "tabId";
+    roles[ThumbnailSourceRole] = "thumbnailSource";
     return roles;
 }
 
@@ -89,7 +90,7 @@ int DeclarativeTabModel::nextTabId() const
 void DeclarativeTabModel::remove(int index) {
     if (!m_tabs.isEmpty() && index >= 0 && index < m_tabs.count()) {
         bool removingActiveTab = activeTabIndex() == index;
-        removeTab(m_tabs.at(index).tabId(), m_tabs.at(index).thumbnailPath(), index);
+        removeTab(m_tabs.at(index).tabId(), index);
         if (removingActiveTab) {
             if (index >= m_tabs.count()) {
                 --index;
@@ -120,7 +121,7 @@ void DeclarativeTabModel::clear()
         return;
 
     for (int i = m_tabs.count() - 1; i >= 0; --i) {
-        removeTab(m_tabs.at(i).tabId(), m_tabs.at(i).thumbnailPath(), i);
+        removeTab(m_tabs.at(i).tabId(), i);
     }
 
     setWaitingForNewTab(false);
@@ -128,8 +129,9 @@ void DeclarativeTabModel::clear()
 
 bool DeclarativeTabModel::activateTab(const QString& url)
 {
+    InternedUrl internedUrl(url);
     for (int i = 0; i < m_tabs.size(); i++) {
-        if (m_tabs.at(i).url() == url) {
+        if (m_tabs.at(i).internedUrl() == internedUrl) {
             return activateTab(i);
         }
     }
@@ -139,7 +141,7 @@ bool DeclarativeTabModel::activateTab(const QString& url)
 bool DeclarativeTabModel::activateTab(int index, bool loadActiveTab)
 {
     if (index >= 0 && index < m_tabs.count()) {
-        const Tab &newActiveTab = m_tabs.at(index);
+        Tab newActiveTab = m_tabs.at(index);
 #if DEBUG_LOGS
         qDebug() << "activate tab: " << index << &newActiveTab;
 #endif
@@ -169,7 +171,7 @@ void DeclarativeTabModel::closeActiveTab()
 {
     if (!m_tabs.isEmpty()) {
         int index = activeTabIndex();
-        removeTab(m_activeTab.tabId(), m_activeTab.thumbnailPath(), index);
+        removeTab(m_activeTab.tabId(), index);
 
         if (index >= m_tabs.count()) {
             --index;
@@ -214,6 +216,8 @@ QVariant DeclarativeTabModel::data(const QModelIndex & index, int role) const {
     const Tab &tab = m_tabs.at(index.row());
     if (role == ThumbPathRole) {
         return tab.thumbnailPath();
+    } else if (role == ThumbnailSourceRole) {
+        return tab.thumbnailPath().isEmpty() ? QString() : ThumbnailCache::instance()->source(tab.tabId(), ThumbnailCache::GridVariant);
     } else if (role == TitleRole) {
         return tab.title();
     } else if (role == UrlRole) {
@@ -330,7 +334,7 @@ void DeclarativeTabModel::tabChanged(const Tab &tab)
     if (i > -1) {
         QVector<int> roles;
         Tab oldTab = m_tabs[i];
-        if (oldTab.url() != tab.url()) {
+        if (oldTab.internedUrl() != tab.internedUrl()) {
             roles << UrlRole;
         }
         if (oldTab.title() != tab.title()) {
@@ -384,16 +388,13 @@ void DeclarativeTabModel::updateTitle(int tabId, bool activeTab, QString url, QS
     }
 }
 
-void DeclarativeTabModel::removeTab(int tabId, const QString &thumbnail, int index)
+void DeclarativeTabModel::removeTab(int tabId, int index)
 {
 #if DEBUG_LOGS
     qDebug() << "index:" << index << tabId;
 #endif
     DBManager::instance()->removeTab(tabId);
-    QFile f(thumbnail);
-    if (f.exists()) {
-        f.remove();
-    }
+    ThumbnailCache::instance()->remove(tabId);
 
     if (index >= 0) {
         if (activeTabIndex() == index) {
@@ -462,7 +463,7 @@ void DeclarativeTabModel::updateTabUrl(int tabId, bool activeTab, const QString
 
     int tabIndex = findTabIndex(tabId);
     bool updateDb = false;
-    if (tabIndex >= 0 && (m_tabs.at(tabIndex).url() != url || activeTab)) {
+    if (tabIndex >= 0 && (m_tabs.at(tabIndex).internedUrl() != InternedUrl::find(url) || activeTab)) {
         QVector<int> roles;
         roles << UrlRole << TitleRole << ThumbPathRole;
         m_tabs[tabIndex].setUrl(url);
@@ -499,17 +500,21 @@ void DeclarativeTabModel::updateThumbnailPath(int tabId, QString path)
         return;
 
     QVector<int> roles;
-    roles << ThumbPathRole;
+    roles << ThumbPathRole << ThumbnailSourceRole;
     for (int i = 0; i < m_tabs.count(); i++) {
-        if (m_tabs.at(i).tabId() == tabId && m_tabs.at(i).thumbnailPath() != path) {
+        if (m_tabs.at(i).tabId() == tabId) {
 #if DEBUG_LOGS
             qDebug() << "model tab thumbnail updated: " << path << i << tabId;
 #endif
-            m_tabs[i].setThumbnailPath(path);
+            // Path of a new thumbnail is usually the same, but its source
+            // in the thumbnail cache changes.
+            if (m_tabs.at(i).thumbnailPath() != path) {
+                m_tabs[i].setThumbnailPath(path);
+                DBManager::instance()->updateThumbPath(tabId, path);
+            }
             QModelIndex start = index(i, 0);
             QModelIndex end = index(i, 0);
             emit dataChanged(start, end, roles);
-            DBManager::instance()->updateThumbPath(tabId, path);
         }
     }
 }
@@ -38,7 +38,8 @@ public:
         ThumbPathRole = Qt::UserRole + 1,
         TitleRole,
         UrlRole,
-        TabIdRole
+        TabIdRole,
+        ThumbnailSourceRole
     };
 
     Q_INVOKABLE void remove(int index);
@@ -105,7 +106,7 @@ private slots:
     void saveActiveTab() const;
 
 private:
-    void removeTab(int tabId, const QString &thumbnail, int index);
+    void removeTab(int tabId, int index);
     int findTabIndex(int tabId) const;
     void updateActiveTab(const Tab &activeTab, bool loadActiveTab);
     void updateTabUrl(int tabId, bool activeTab, const QString &url, bool navigate);
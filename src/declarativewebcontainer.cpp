@@ -15,6 +15,7 @@
 #include "dbmanager.h"
 #include "downloadmanager.h"
 #include "declarativewebutils.h"
+#include "thumbnailcache.h"
 
 #include <QPointer>
 #include <QTimerEvent>
@@ -34,6 +35,13 @@
 #define DEBUG_LOGS 0
 #endif
 
+// Link ids grow on every navigation. Most recently navigated tab has the
+// largest current link id.
+static bool mostRecentlyUsed(const Tab &tab1, const Tab &tab2)
+{
+    return tab1.currentLink() > tab2.currentLink();
+}
+
 DeclarativeWebContainer::DeclarativeWebContainer(QQuickItem *parent)
     : QQuickItem(parent)
     , m_webPage(0)
@@ -56,6 +64,7 @@ DeclarativeWebContainer::DeclarativeWebContainer(QQuickItem *parent)
     , m_canGoForward(false)
     , m_canGoBack(false)
     , m_realNavigation(false)
+    , m_placeholderVisible(false)
     , m_completed(false)
     , m_initialized(false)
 {
@@ -180,6 +189,18 @@ void DeclarativeWebContainer::setMaxLiveTabCount(int count)
     }
 }
 
+int DeclarativeWebContainer::preloadTabCount() const
+{
+    return m_webPages->maxPreloadPages();
+}
+
+void DeclarativeWebContainer::setPreloadTabCount(int count)
+{
+    if (m_webPages->setMaxPreloadPages(count)) {
+        emit preloadTabCountChanged();
+    }
+}
+
 bool DeclarativeWebContainer::background() const
 {
     return m_webPage ? m_webPage->background() : false;
@@ -265,6 +286,21 @@ QString DeclarativeWebContainer::url() const
     return m_webPage ? m_webPage->url().toString() : m_url;
 }
 
+QString DeclarativeWebContainer::placeholderSource() const
+{
+    return m_placeholderSource;
+}
+
+QRectF DeclarativeWebContainer::placeholderRect() const
+{
+    return m_placeholderRect;
+}
+
+bool DeclarativeWebContainer::placeholderVisible() const
+{
+    return m_placeholderVisible;
+}
+
 bool DeclarativeWebContainer::isActiveTab(int tabId)
 {
     return m_webPage && m_webPage->tabId() == tabId;
@@ -315,6 +351,7 @@ void DeclarativeWebContainer::goForward()
             emit canGoBackChanged();
         }
 
+        m_backForwardCache.storeContentRect(m_webPage->tabId(), m_url, m_webPage->contentRect());
         m_webPage->setBackForwardNavigation(true);
         m_realNavigation = m_webPage->canGoForward();
         DBManager::instance()->goForward(m_webPage->tabId());
@@ -335,6 +372,7 @@ void DeclarativeWebContainer::goBack()
             emit canGoForwardChanged();
         }
 
+        m_backForwardCache.storeContentRect(m_webPage->tabId(), m_url, m_webPage->contentRect());
         m_webPage->setBackForwardNavigation(true);
         m_realNavigation = m_webPage->canGoBack();
         // When executing non real back navigation, we're adding
@@ -366,6 +404,13 @@ bool DeclarativeWebContainer::activatePage(int tabId, bool force, int parentId)
     if ((m_model->loaded() || force) && tabId > 0 && m_webPages->initialized()) {
         WebPageActivationData activationData = m_webPages->page(tabId, parentId);
         setWebPage(activationData.webPage);
+        // Restore engine history of a recreated page.
+        if (activationData.activated && !m_webPage->viewReady() && !m_webPage->pageState().isValid()) {
+            QVariant sessionHistory = m_backForwardCache.sessionHistory(tabId);
+            if (sessionHistory.isValid()) {
+                m_webPage->setPageState(sessionHistory);
+            }
+        }
         // Reset always height so that orentation change is taken into account.
         m_webPage->forceChrome(false);
         m_webPage->setChrome(true);
@@ -378,6 +423,8 @@ bool DeclarativeWebContainer::activatePage(int tabId, bool force, int parentId)
         connect(m_webPage, SIGNAL(titleChanged()), this, SLOT(onPageTitleChanged()), Qt::UniqueConnection);
         connect(m_webPage, SIGNAL(domContentLoadedChanged()), this, SLOT(sendVkbOpenCompositionMetrics()), Qt::UniqueConnection);
         connect(m_webPage, SIGNAL(backgroundChanged()), this, SIGNAL(backgroundChanged()), Qt::UniqueConnection);
+        connect(m_webPage, SIGNAL(pageStateChanged()), this, SLOT(onPageStateChanged()), Qt::UniqueConnection);
+        updatePlaceholder();
         return activationData.activated;
     }
     return false;
@@ -478,10 +525,78 @@ void DeclarativeWebContainer::onActiveTabChanged(int oldTabId, int activeTabId,
     if (oldTabId != activeTabId) {
         reload(false);
     } else if (!m_realNavigation && isActiveTab(activeTabId) && m_webPage->backForwardNavigation()) {
+        // Engine has no history for this. Return to the position where the page was left.
+        const BackForwardCache::Entry *entry = m_backForwardCache.find(activeTabId, m_url);
+        if (entry && !entry->contentRect.isEmpty()) {
+            m_webPage->setResurrectedContentRect(entry->contentRect);
+        }
         m_webPage->loadTab(m_url, false);
     }
 }
 
+void DeclarativeWebContainer::onPageStateChanged()
+{
+    DeclarativeWebPage *webPage = qobject_cast<DeclarativeWebPage *>(sender());
+    if (webPage) {
+        m_backForwardCache.setSessionHistory(webPage->tabId(), webPage->pageState());
+    }
+}
+
+/**
+ * Shows thumbnail of the active tab over its page until the page paints for the
+ * first time. Resurrected and restored pages are blank until reloaded from the
+ * network. The thumbnail is positioned so that its content lines up with the
+ * content rect the page is restored to. Width of the placeholder rect is set,
+ * height follows the aspect ratio of the thumbnail.
+ */
+void DeclarativeWebContainer::updatePlaceholder()
+{
+    ThumbnailCache *cache = ThumbnailCache::instance();
+    int tabId = m_webPage ? m_webPage->tabId() : 0;
+    bool visible = tabId > 0 && !m_webPage->isPainted() && cache->contains(tabId);
+
+    if (visible) {
+        QRectF rect(0, 0, width(), 0);
+        QRectF grabbed = cache->contentRect(tabId);
+        if (grabbed.width() > 0) {
+            // New loads start from the top of the page.
+            QRectF restored = m_webPage->resurrectedContentRect().toRectF();
+            if (restored.width() <= 0) {
+                restored = QRectF(QPointF(0, 0), grabbed.size());
+            }
+            qreal scale = width() / restored.width();
+            rect = QRectF((grabbed.x() - restored.x()) * scale, (grabbed.y() - restored.y()) * scale,
+                          grabbed.width() * scale, 0);
+        }
+
+        // Nothing of the thumbnail would be visible.
+        visible = rect.y() < height() && rect.x() < width() && rect.right() > 0;
+        if (visible) {
+            m_placeholderSource = cache->source(tabId, ThumbnailCache::GridVariant);
+            m_placeholderRect = rect;
+            connect(m_webPage, SIGNAL(firstPaint(int,int)), this, SLOT(hidePlaceholder()), Qt::UniqueConnection);
+        }
+    }
+
+#if DEBUG_LOGS
+    qDebug() << "tab:" << tabId << "placeholder:" << visible << m_placeholderRect;
+#endif
+
+    if (visible || m_placeholderVisible) {
+        m_placeholderVisible = visible;
+        emit placeholderChanged();
+    }
+}
+
+void DeclarativeWebContainer::hidePlaceholder()
+{
+    if (sender() == m_webPage && m_placeholderVisible) {
+        disconnect(m_webPage, SIGNAL(firstPaint(int,int)), this, SLOT(hidePlaceholder()));
+        m_placeholderVisible = false;
+        emit placeholderChanged();
+    }
+}
+
 void DeclarativeWebContainer::initialize()
 {
     // This signal handler is responsible for activating
@@ -522,6 +637,14 @@ void DeclarativeWebContainer::initialize()
         QString url = m_url.isEmpty() ? tab.url() : m_url;
         QString title = url == m_url ? m_title : tab.title();
         loadTab(tab.tabId(), url, title, true);
+
+        // Load recently used tabs of the previous session in background.
+        if (preloadTabCount() > 0) {
+            QList<Tab> tabs = m_model->tabs();
+            tabs.removeAll(tab);
+            qSort(tabs.begin(), tabs.end(), mostRecentlyUsed);
+            m_webPages->preload(tabs);
+        }
     }
 
     if (isComponentComplete() && !m_completed) {
@@ -575,13 +698,19 @@ void DeclarativeWebContainer::onNewTabRequested(QString url, QString title, int
     }
 
     if (activatePage(m_model->nextTabId(), false, parentId)) {
-        m_webPage->setInitialUrl(url);
+        // A claimed spare page might already be initialized.
+        if (m_webPage->viewReady()) {
+            m_webPage->loadTab(url, false);
+        } else {
+            m_webPage->setInitialUrl(url);
+        }
     }
 }
 
 void DeclarativeWebContainer::onTabsCleared()
 {
     m_webPages->clear();
+    m_backForwardCache.clear();
     // Trigger contentItem changed and then reset title, url, and tabId.
     emit contentItemChanged();
     updateTitle("");
@@ -606,6 +735,10 @@ int DeclarativeWebContainer::parentTabId(int tabId) const
 
 void DeclarativeWebContainer::releasePage(int tabId, bool virtualize)
 {
+    if (!virtualize) {
+        m_backForwardCache.remove(tabId);
+    }
+
     if (m_webPages) {
         m_webPages->release(tabId, virtualize);
         // Successfully destroyed. Emit relevant property changes.
@@ -807,7 +940,7 @@ void DeclarativeWebContainer::updateUrl(const QString &newUrl)
     }
 
     if (m_url != newUrl) {
-        m_url = newUrl;
+        m_url = internUrl(newUrl);
         emit urlChanged();
     }
 }
@@ -12,6 +12,7 @@
 #ifndef DECLARATIVEWEBCONTAINER_H
 #define DECLARATIVEWEBCONTAINER_H
 
+#include "backforwardcache.h"
 #include "settingmanager.h"
 #include "tab.h"
 #include "webpages.h"
@@ -33,6 +34,7 @@ class DeclarativeWebContainer : public QQuickItem {
     Q_PROPERTY(bool completed READ completed NOTIFY completedChanged FINAL)
     Q_PROPERTY(bool foreground READ foreground WRITE setForeground NOTIFY foregroundChanged FINAL)
     Q_PROPERTY(int maxLiveTabCount READ maxLiveTabCount WRITE setMaxLiveTabCount NOTIFY maxLiveTabCountChanged FINAL)
+    Q_PROPERTY(int preloadTabCount READ preloadTabCount WRITE setPreloadTabCount NOTIFY preloadTabCountChanged FINAL)
     // This property should cover all possible popus
     Q_PROPERTY(bool popupActive MEMBER m_popupActive NOTIFY popupActiveChanged FINAL)
     Q_PROPERTY(bool portrait MEMBER m_portrait NOTIFY portraitChanged FINAL)
@@ -58,6 +60,11 @@ class DeclarativeWebContainer : public QQuickItem {
     Q_PROPERTY(QString title READ title NOTIFY titleChanged FINAL)
     Q_PROPERTY(QString url READ url NOTIFY urlChanged FINAL)
 
+    // Thumbnail of the active tab shown until its page has painted.
+    Q_PROPERTY(QString placeholderSource READ placeholderSource NOTIFY placeholderChanged FINAL)
+    Q_PROPERTY(QRectF placeholderRect READ placeholderRect NOTIFY placeholderChanged FINAL)
+    Q_PROPERTY(bool placeholderVisible READ placeholderVisible NOTIFY placeholderChanged FINAL)
+
     Q_PROPERTY(QQmlComponent* webPageComponent MEMBER m_webPageComponent NOTIFY webPageComponentChanged FINAL)
 
 public:
@@ -77,6 +84,9 @@ public:
     int maxLiveTabCount() const;
     void setMaxLiveTabCount(int count);
 
+    int preloadTabCount() const;
+    void setPreloadTabCount(int count);
+
     bool background() const;
 
     bool loading() const;
@@ -100,6 +110,10 @@ public:
     QString url() const;
     QString thumbnailPath() const;
 
+    QString placeholderSource() const;
+    QRectF placeholderRect() const;
+    bool placeholderVisible() const;
+
     bool isActiveTab(int tabId);
     bool activatePage(int tabId, bool force = false, int parentId = 0);
 
@@ -120,6 +134,7 @@ signals:
     void backgroundChanged();
     void allowHidingChanged();
     void maxLiveTabCountChanged();
+    void preloadTabCountChanged();
     void popupActiveChanged();
     void portraitChanged();
     void fullscreenModeChanged();
@@ -140,6 +155,7 @@ signals:
     void titleChanged();
     void urlChanged();
     void thumbnailPathChanged();
+    void placeholderChanged();
 
     void webPageComponentChanged();
 
@@ -165,6 +181,8 @@ private slots:
     void updateLoadProgress();
     void updateLoading();
     void setActiveTabData();
+    void onPageStateChanged();
+    void hidePlaceholder();
 
     void updateWindowFlags();
 
@@ -182,12 +200,16 @@ private:
     void updateTitle(const QString &newTitle);
     bool canInitialize() const;
     void loadTab(int tabId, QString url, QString title, bool force);
+    void updatePlaceholder();
 
     QPointer<DeclarativeWebPage> m_webPage;
     QPointer<DeclarativeTabModel> m_model;
     QPointer<QQmlComponent> m_webPageComponent;
     QPointer<SettingManager> m_settingManager;
     QScopedPointer<WebPages> m_webPages;
+    // Content rects and engine session histories of visited pages.
+    // Used when the engine has no history of its own to navigate with.
+    BackForwardCache m_backForwardCache;
     bool m_foreground;
     bool m_allowHiding;
     bool m_popupActive;
@@ -218,6 +240,10 @@ private:
     bool m_canGoBack;
     bool m_realNavigation;
 
+    QString m_placeholderSource;
+    QRectF m_placeholderRect;
+    bool m_placeholderVisible;
+
     bool m_completed;
     bool m_initialized;
 
@@ -11,9 +11,14 @@
 
 #include "declarativewebpage.h"
 #include "declarativewebcontainer.h"
+#include "blackframe.h"
+#include "iconstore.h"
+#include "internedurl.h"
+#include "thumbnailcache.h"
+#include "thumbnailpipeline.h"
+#include "webpagetrace.h"
 
 #include <QtConcurrent>
-#include <QStandardPaths>
 
 static const QString gFullScreenMessage("embed:fullscreenchanged");
 static const QString gDomContentLoadedMessage("embed:domcontentloaded");
@@ -31,26 +36,13 @@ static const QString gSelectionRangeMessage("Content:SelectionRange");
 static const QString gSelectionCopiedMessage("Content:SelectionCopied");
 static const QString gSelectAsyncMessage("embed:selectasync");
 static const QString gFilePickerMessage("embed:filepicker");
+static const QString gPageStateMessage("embed:pagestate");
 
-bool isBlack(QRgb rgb)
-{
-    return qRed(rgb) == 0 && qGreen(rgb) == 0 && qBlue(rgb) == 0;
-}
+static const QString gSavePageStateMessage("embedui:savepagestate");
+static const QString gRestorePageStateMessage("embedui:restorepagestate");
 
-bool allBlack(const QImage &image)
-{
-    int h = image.height();
-    int w = image.width();
-
-    for (int j = 0; j < h; ++j) {
-        const QRgb *b = (const QRgb *)image.constScanLine(j);
-        for (int i = 0; i < w; ++i) {
-            if (!isBlack(b[i]))
-                return false;
-        }
-    }
-    return true;
-}
+// Minimum interval between thumbnail grabs of a tab.
+static const int gMinGrabInterval = 2000;
 
 DeclarativeWebPage::DeclarativeWebPage(QQuickItem *parent)
     : QuickMozView(parent)
@@ -64,19 +56,27 @@ DeclarativeWebPage::DeclarativeWebPage(QQuickItem *parent)
     , m_urlHasChanged(false)
     , m_backForwardNavigation(false)
     , m_boundToModel(false)
+    , m_grabRequested(false)
+    , m_thumbnailSize(0)
 {
     connect(this, SIGNAL(viewInitialized()), this, SLOT(onViewInitialized()));
     connect(this, SIGNAL(recvAsyncMessage(const QString, const QVariant)),
             this, SLOT(onRecvAsyncMessage(const QString&, const QVariant&)));
     connect(&m_grabWritter, SIGNAL(finished()), this, SLOT(grabWritten()));
+    connect(&m_thumbnailWriter, SIGNAL(finished()), this, SLOT(thumbnailWritten()));
+    m_grabTimer.setSingleShot(true);
+    connect(&m_grabTimer, SIGNAL(timeout()), this, SLOT(grabToFile()));
     connect(this, SIGNAL(contentHeightChanged()), this, SLOT(resetHeight()));
     connect(this, SIGNAL(scrollableOffsetChanged()), this, SLOT(resetHeight()));
 }
 
 DeclarativeWebPage::~DeclarativeWebPage()
 {
+    WebPageTrace::instance()->record(WebPageTrace::Delete, m_tabId);
     m_grabWritter.cancel();
     m_grabWritter.waitForFinished();
+    m_thumbnailWriter.cancel();
+    m_thumbnailWriter.waitForFinished();
     m_grabResult.clear();
     m_thumbnailResult.clear();
 }
@@ -103,6 +103,10 @@ void DeclarativeWebPage::setTabId(int tabId)
 {
     if (m_tabId != tabId) {
         m_tabId = tabId;
+        // Grab rate limit is per tab.
+        m_lastGrab.invalidate();
+        m_grabTimer.stop();
+        m_grabRequested = false;
         emit tabIdChanged();
     }
 }
@@ -124,7 +128,7 @@ void DeclarativeWebPage::setUrlHasChanged(bool urlHasChanged)
 
 void DeclarativeWebPage::setInitialUrl(const QString &url)
 {
-    m_initialUrl = url;
+    m_initialUrl = internUrl(url);
 }
 
 void DeclarativeWebPage::bindToModel()
@@ -165,6 +169,33 @@ void DeclarativeWebPage::setResurrectedContentRect(QVariant resurrectedContentRe
     }
 }
 
+/**
+ * Returns the latest page state received from the embed helper. The state contains
+ * session history, scroll positions, zoom and form data of the page. It is
+ * refreshed by calling requestPageState().
+ */
+QVariant DeclarativeWebPage::pageState() const
+{
+    return m_pageState;
+}
+
+/**
+ * Sets state of a virtualized page. The state is sent to the embed helper when
+ * the root frame of the page has loaded its DOM content.
+ */
+void DeclarativeWebPage::setPageState(const QVariant &pageState)
+{
+    m_pageState = pageState;
+    m_restoredPageState = pageState;
+}
+
+void DeclarativeWebPage::requestPageState()
+{
+    if (m_viewReady) {
+        sendAsyncMessage(gSavePageStateMessage, QVariant());
+    }
+}
+
 void DeclarativeWebPage::loadTab(QString newUrl, bool force)
 {
     // Always enable chrome when load is called.
@@ -182,7 +213,22 @@ void DeclarativeWebPage::grabToFile()
     if (!m_viewReady || backForwardNavigation() || !active() || !isPainted())
         return;
 
-    emit clearGrabResult();
+    // Load completions and popups request grabs in bursts. A grab requested
+    // while the previous one is still grabbed or written is taken once that
+    // finishes, one requested too soon after the previous one is delayed.
+    if (!m_grabResult.isNull() || m_grabWritter.isRunning()) {
+        m_grabRequested = true;
+        return;
+    }
+    qint64 sinceLastGrab = m_lastGrab.isValid() ? m_lastGrab.elapsed() : gMinGrabInterval;
+    if (sinceLastGrab < gMinGrabInterval) {
+        m_grabTimer.start(gMinGrabInterval - sinceLastGrab);
+        return;
+    }
+    m_grabTimer.stop();
+    m_grabRequested = false;
+    m_lastGrab.start();
+
     // grabToImage handles invalid geometry.
     m_grabResult = grabToImage();
     if (m_grabResult.data()) {
@@ -190,8 +236,14 @@ void DeclarativeWebPage::grabToFile()
     }
 }
 
-void DeclarativeWebPage::grabThumbnail()
+/**
+ * Grabs a square thumbnail of the page for a bookmark icon. The thumbnail is
+ * downscaled to \a size, if given, and delivered as an IconStore handle by
+ * thumbnailResult().
+ */
+void DeclarativeWebPage::grabThumbnail(int size)
 {
+    m_thumbnailSize = size;
     m_thumbnailResult = grabToImage();
     connect(m_thumbnailResult.data(), SIGNAL(ready()), this, SLOT(thumbnailReady()));
 }
@@ -249,6 +301,7 @@ void DeclarativeWebPage::resetHeight(bool respectContentHeight)
 void DeclarativeWebPage::componentComplete()
 {
     QuickMozView::componentComplete();
+    WebPageTrace::instance()->record(WebPageTrace::Create, m_tabId);
 }
 
 void DeclarativeWebPage::onViewInitialized()
@@ -269,10 +322,13 @@ void DeclarativeWebPage::onViewInitialized()
     addMessageListener(gSelectionCopiedMessage);
     addMessageListener(gSelectAsyncMessage);
     addMessageListener(gFilePickerMessage);
+    addMessageListener(gPageStateMessage);
 
     loadFrameScript("chrome://embedlite/content/SelectAsyncHelper.js");
     loadFrameScript("chrome://embedlite/content/embedhelper.js");
 
+    WebPageTrace::instance()->record(WebPageTrace::ViewInitialized, m_tabId);
+
     // This is the only place that is allowed to change this to true.
     m_viewReady = true;
     emit viewReadyChanged();
@@ -292,13 +348,22 @@ void DeclarativeWebPage::grabResultReady()
     h = qMax(h / 3, w / 2);
     QRect cropBounds(0, 0, w, h);
 
-    m_grabWritter.setFuture(QtConcurrent::run(this, &DeclarativeWebPage::saveToFile, image, cropBounds));
+    m_grabWritter.setFuture(QtConcurrent::run(&DeclarativeWebPage::saveToFile, image, cropBounds, m_tabId,
+                                              url().toString(), contentRect()));
 }
 
 void DeclarativeWebPage::grabWritten()
 {
-    QString path = m_grabWritter.result();
-    emit grabResult(path);
+    GrabWrite write = m_grabWritter.result();
+    if (write.changed) {
+        emit grabResult(write.path);
+    }
+
+    // Take the grab that was requested while this one was in progress.
+    if (m_grabRequested) {
+        m_grabRequested = false;
+        grabToFile();
+    }
 }
 
 void DeclarativeWebPage::thumbnailReady()
@@ -308,28 +373,45 @@ void DeclarativeWebPage::thumbnailReady()
     int size = qMin(width(), height());
     QRect cropBounds(0, 0, size, size);
 
-    image = image.copy(cropBounds);
-    QByteArray iconData;
-    QBuffer buffer(&iconData);
-    buffer.open(QIODevice::WriteOnly);
-    if (image.save(&buffer, "jpg", 75)) {
-        buffer.close();
-        emit thumbnailResult(QString(BASE64_IMAGE).arg(QString(iconData.toBase64())));
-    } else {
-        emit thumbnailResult(DEFAULT_DESKTOP_BOOKMARK_ICON);
-    }
+    m_thumbnailWriter.setFuture(QtConcurrent::run(&DeclarativeWebPage::encodeThumbnail, image, cropBounds, m_thumbnailSize));
+}
+
+void DeclarativeWebPage::thumbnailWritten()
+{
+    QString data = m_thumbnailWriter.result();
+    emit thumbnailResult(!data.isEmpty() ? data : QString(DEFAULT_DESKTOP_BOOKMARK_ICON));
 }
 
-QString DeclarativeWebPage::saveToFile(QImage image, QRect cropBounds)
+// Runs on a worker thread.
+DeclarativeWebPage::GrabWrite DeclarativeWebPage::saveToFile(QImage image, QRect cropBounds, int tabId, QString url, QRectF contentRect)
 {
-    if (image.isNull()) {
-        return "";
+    GrabWrite write;
+    ThumbnailCache *cache = ThumbnailCache::instance();
+    // Black check runs on the full resolution crop, downscaling could hide faint content.
+    if (image.isNull() || allBlack(ThumbnailPipeline::crop(image, cropBounds))) {
+        // Tab loses its thumbnail. The next good grab must not be skipped as unchanged.
+        cache->clearSignature(tabId);
+        return write;
+    }
+
+    image = ThumbnailPipeline::process(image, cropBounds, cache->variantWidth(ThumbnailCache::GridVariant));
+    QByteArray signature = ThumbnailPipeline::signature(image);
+    if (cache->isCurrent(tabId, url, signature)) {
+        write.changed = false;
+        return write;
     }
 
-    // 75% quality jpg produces small and good enough capture.
-    QString path = QString("%1/tab-%2-thumb.jpg").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).arg(m_tabId);
-    image = image.copy(cropBounds);
-    return !allBlack(image) && image.save(path, "jpg", 75) ? path : "";
+    write.path = cache->store(tabId, image, signature, contentRect, url);
+    return write;
+}
+
+// Runs on a worker thread.
+QString DeclarativeWebPage::encodeThumbnail(QImage image, QRect cropBounds, int size)
+{
+    // Launcher icons are small, png is lossless and cheap at that size.
+    ThumbnailPipeline pipeline(ThumbnailPipeline::Png);
+    QByteArray data = pipeline.encode(ThumbnailPipeline::process(image, cropBounds, size));
+    return !data.isEmpty() ? IconStore::instance()->add(data) : QString();
 }
 
 void DeclarativeWebPage::onRecvAsyncMessage(const QString& message, const QVariant& data)
@@ -339,6 +421,14 @@ void DeclarativeWebPage::onRecvAsyncMessage(const QString& message, const QVaria
     } else if (message == gDomContentLoadedMessage && data.toMap().value("rootFrame").toBool()) {
         m_domContentLoaded = true;
         emit domContentLoadedChanged();
+
+        if (m_restoredPageState.isValid()) {
+            sendAsyncMessage(gRestorePageStateMessage, m_restoredPageState);
+            m_restoredPageState.clear();
+        }
+    } else if (message == gPageStateMessage) {
+        m_pageState = data;
+        emit pageStateChanged();
     }
 }
 
@@ -13,11 +13,14 @@
 #define DECLARATIVEWEBPAGE_H
 
 #include <qqml.h>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
+#include <QImage>
 #include <QQuickItemGrabResult>
 #include <QPointer>
 #include <quickmozview.h>
 #include <QRgb>
+#include <QTimer>
 
 class DeclarativeWebContainer;
 
@@ -56,6 +59,10 @@ public:
 
     void setInitialUrl(const QString &url);
 
+    QVariant pageState() const;
+    void setPageState(const QVariant &pageState);
+    void requestPageState();
+
     void bindToModel();
     bool boundToModel();
 
@@ -65,11 +72,11 @@ public:
     bool viewReady() const;
 
     Q_INVOKABLE void loadTab(QString newUrl, bool force);
-    Q_INVOKABLE void grabToFile();
-    Q_INVOKABLE void grabThumbnail();
+    Q_INVOKABLE void grabThumbnail(int size = 0);
     Q_INVOKABLE void forceChrome(bool forcedChrome);
 
 public slots:
+    void grabToFile();
     void resetHeight(bool respectContentHeight = true);
 
 signals:
@@ -82,9 +89,9 @@ signals:
     void domContentLoadedChanged();
     void faviconChanged();
     void resurrectedContentRectChanged();
-    void clearGrabResult();
     void grabResult(QString fileName);
     void thumbnailResult(QString data);
+    void pageStateChanged();
 
     void fullscreenHeightChanged();
     void toolbarHeightChanged();
@@ -99,9 +106,18 @@ private slots:
     void grabResultReady();
     void grabWritten();
     void thumbnailReady();
+    void thumbnailWritten();
 
 private:
-    QString saveToFile(QImage image, QRect cropBounds);
+    struct GrabWrite {
+        GrabWrite() : changed(true) {}
+
+        QString path; // Empty if the page has no thumbnail
+        bool changed; // False if writing was skipped as the thumbnail looks the same
+    };
+
+    static GrabWrite saveToFile(QImage image, QRect cropBounds, int tabId, QString url, QRectF contentRect);
+    static QString encodeThumbnail(QImage image, QRect cropBounds, int size);
 
     QPointer<DeclarativeWebContainer> m_container;
     int m_tabId;
@@ -114,11 +130,19 @@ private:
     bool m_backForwardNavigation;
     bool m_boundToModel;
     QString m_initialUrl;
+    QVariant m_pageState;
+    QVariant m_restoredPageState;
     QString m_favicon;
     QVariant m_resurrectedContentRect;
     QSharedPointer<QQuickItemGrabResult> m_grabResult;
     QSharedPointer<QQuickItemGrabResult> m_thumbnailResult;
-    QFutureWatcher<QString> m_grabWritter;
+    QFutureWatcher<GrabWrite> m_grabWritter;
+    QElapsedTimer m_lastGrab;
+    QTimer m_grabTimer;
+    // Grab was requested while the previous one was still in progress.
+    bool m_grabRequested;
+    QFutureWatcher<QString> m_thumbnailWriter;
+    int m_thumbnailSize;
 
     qreal m_fullScreenHeight;
     qreal m_toolbarHeight;
@@ -10,6 +10,7 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "desktopbookmarkwriter.h"
+#include "iconstore.h"
 
 #include <QDir>
 #include <QStandardPaths>
@@ -47,6 +48,11 @@ void DesktopBookmarkWriter::save(QString url, QString title, QString icon)
         return;
     }
 
+    // Launcher cannot resolve icon handles of the browser, refer to the icon file.
+    if (IconStore::isHandle(icon)) {
+        icon = IconStore::instance()->path(icon);
+    }
+
     if (icon.isEmpty()) {
         icon = DEFAULT_DESKTOP_BOOKMARK_ICON;
     }
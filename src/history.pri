@@ -1,21 +1,38 @@
 # C++ sources
 SOURCES += \
+    $$PWD/bookmark.cpp \
     $$PWD/declarativetabmodel.cpp \
     $$PWD/dbmanager.cpp \
     $$PWD/dbworker.cpp \
+    $$PWD/internedurl.cpp \
     $$PWD/link.cpp \
     $$PWD/linkvalidator.cpp \
     $$PWD/declarativehistorymodel.cpp \
-    $$PWD/tab.cpp
+    $$PWD/declarativesuggestionmodel.cpp \
+    $$PWD/suggestionengine.cpp \
+    $$PWD/tab.cpp \
+    $$PWD/thumbnailcache.cpp \
+    $$PWD/thumbnailpipeline.cpp
 
 # C++ headers
 HEADERS += \
+    $$PWD/bookmark.h \
     $$PWD/declarativetabmodel.h \
     $$PWD/dbmanager.h \
     $$PWD/dbworker.h \
+    $$PWD/internedurl.h \
+    $$PWD/keyedlistmodel.h \
     $$PWD/link.h \
     $$PWD/linkvalidator.h \
     $$PWD/declarativehistorymodel.h \
-    $$PWD/tab.h
+    $$PWD/declarativesuggestionmodel.h \
+    $$PWD/suggestionengine.h \
+    $$PWD/tab.h \
+    $$PWD/thumbnailcache.h \
+    $$PWD/thumbnailpipeline.h
+
+# SuggestionEngine interrupts history queries through the SQLite API.
+CONFIG += link_pkgconfig
+PKGCONFIG += sqlite3
 
 DEFINES += DB_NAME=\\\"sailfish-browser.sqlite\\\"
@@ -11,7 +11,10 @@
 
 #include "iconfetcher.h"
 
-#include <QImage>
+#include "iconstore.h"
+
+#include <QBuffer>
+#include <QImageReader>
 
 IconFetcher::IconFetcher(QObject *parent)
     : QObject(parent)
@@ -64,12 +67,17 @@ void IconFetcher::dataReady()
     QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
     if (reply) {
         QByteArray iconData = reply->readAll();
-        QImage image;
-        image.loadFromData(iconData);
-        if (image.width() < m_minimumIconSize || image.height() < m_minimumIconSize) {
+        QBuffer buffer(&iconData);
+        buffer.open(QIODevice::ReadOnly);
+        // Only the header is needed for the size, the icon is decoded when shown.
+        QSize size = QImageReader(&buffer).size();
+        if (size.width() < m_minimumIconSize || size.height() < m_minimumIconSize) {
             m_data = defaultIcon();
         } else {
-            m_data = QString(BASE64_IMAGE).arg(QString(iconData.toBase64()));
+            m_data = IconStore::instance()->add(iconData);
+            if (m_data.isEmpty()) {
+                m_data = defaultIcon();
+            }
         }
         reply->deleteLater();
 
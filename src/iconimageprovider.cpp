@@ -0,0 +1,37 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "iconimageprovider.h"
+#include "iconstore.h"
+
+IconImageProvider::IconImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image, QQmlImageProviderBase::ForceAsynchronousImageLoading)
+{
+}
+
+QImage IconImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    // QML passes 0 for a dimension that is not constrained. Icons are roughly
+    // square, the constrained dimension bounds both.
+    int bound = qMax(requestedSize.width(), requestedSize.height());
+    QSize requested;
+    if (requestedSize.width() > 0 && requestedSize.height() > 0) {
+        requested = requestedSize;
+    } else if (bound > 0) {
+        requested = QSize(bound, bound);
+    }
+
+    QImage image = IconStore::instance()->image(id, requested);
+    if (size) {
+        *size = image.size();
+    }
+    return image;
+}
@@ -0,0 +1,26 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ICONIMAGEPROVIDER_H
+#define ICONIMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+
+// Serves icons of IconStore. Image ids are icon hashes, see IconStore::add().
+class IconImageProvider : public QQuickImageProvider
+{
+public:
+    IconImageProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // ICONIMAGEPROVIDER_H
@@ -0,0 +1,194 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "iconstore.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#ifndef DEBUG_LOGS
+#define DEBUG_LOGS 0
+#endif
+
+static const int gMaxMemorySize = 2 * 1024 * 1024;
+static const QString gHandlePrefix("image://browsericon/");
+
+Q_GLOBAL_STATIC(IconStore, iconStore)
+
+IconStore *IconStore::instance()
+{
+    return iconStore();
+}
+
+IconStore::IconStore()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + QLatin1String("/icons"))
+    , m_images(gMaxMemorySize)
+{
+}
+
+/**
+ * Stores encoded icon \a data and returns its handle, or an empty string if
+ * the data is not an image. Storing the same data again returns the same handle.
+ */
+QString IconStore::add(const QByteArray &data)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QByteArray format = QImageReader::imageFormat(&buffer);
+    if (format.isEmpty()) {
+        return QString();
+    }
+
+    QString hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+    QMutexLocker locker(&m_mutex);
+    if (findPath(hash).isEmpty()) {
+        QDir().mkpath(m_directory);
+        QString fileName = QString("%1/%2.%3").arg(m_directory, hash, QString::fromLatin1(format));
+        QSaveFile file(fileName);
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+            qWarning() << "Cannot write icon" << fileName;
+            return QString();
+        }
+#if DEBUG_LOGS
+        qDebug() << "stored icon:" << fileName << data.size();
+#endif
+        m_paths.insert(hash, fileName);
+    }
+    return gHandlePrefix + hash;
+}
+
+/**
+ * Stores the icon of a base64 \a dataUrl and returns its handle. Anything else
+ * than a data url is returned as is.
+ */
+QString IconStore::addDataUrl(const QString &dataUrl)
+{
+    if (!isDataUrl(dataUrl)) {
+        return dataUrl;
+    }
+
+    int start = dataUrl.indexOf(QLatin1String(";base64,"));
+    if (start < 0) {
+        return dataUrl;
+    }
+
+    QString handle = add(QByteArray::fromBase64(dataUrl.mid(start + 8).toLatin1()));
+    return !handle.isEmpty() ? handle : dataUrl;
+}
+
+/**
+ * Returns the icon \a hash decoded at \a requestedSize, if given. Decoded icons
+ * are cached per size.
+ */
+QImage IconStore::image(const QString &hash, const QSize &requestedSize)
+{
+    QString key = QString("%1/%2x%3").arg(hash).arg(requestedSize.width()).arg(requestedSize.height());
+    QString fileName;
+    {
+        QMutexLocker locker(&m_mutex);
+        QImage *image = m_images.object(key);
+        if (image) {
+            return *image;
+        }
+        fileName = findPath(hash);
+    }
+
+    QImageReader reader(fileName);
+    QSize size = reader.size();
+    if (size.isValid() && requestedSize.isValid()
+            && (requestedSize.width() < size.width() || requestedSize.height() < size.height())) {
+        reader.setScaledSize(size.scaled(requestedSize.expandedTo(QSize(1, 1)), Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (!image.isNull()) {
+        QMutexLocker locker(&m_mutex);
+        m_images.insert(key, new QImage(image), image.byteCount());
+    }
+    return image;
+}
+
+/**
+ * Returns local file path of the \a icon handle, or an empty string if the
+ * icon is not in the store.
+ */
+QString IconStore::path(const QString &icon)
+{
+    QString iconHash = hash(icon);
+    if (iconHash.isEmpty()) {
+        return QString();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    return findPath(iconHash);
+}
+
+void IconStore::clearMemory()
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.clear();
+}
+
+int IconStore::memorySize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_images.totalCost();
+}
+
+void IconStore::setDirectory(const QString &directory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+    m_paths.clear();
+    m_images.clear();
+}
+
+bool IconStore::isHandle(const QString &icon)
+{
+    return icon.startsWith(gHandlePrefix);
+}
+
+bool IconStore::isDataUrl(const QString &icon)
+{
+    return icon.startsWith(QLatin1String("data:image/"));
+}
+
+QString IconStore::hash(const QString &icon)
+{
+    return isHandle(icon) ? icon.mid(gHandlePrefix.length()) : QString();
+}
+
+// Called with the mutex held.
+QString IconStore::findPath(const QString &hash)
+{
+    QHash<QString, QString>::const_iterator cached = m_paths.constFind(hash);
+    if (cached != m_paths.constEnd()) {
+        return cached.value();
+    }
+
+    // File suffix is the image format.
+    QStringList files = QDir(m_directory).entryList(QStringList() << hash + QLatin1String(".*"), QDir::Files);
+    if (files.isEmpty()) {
+        return QString();
+    }
+
+    QString fileName = m_directory + QLatin1Char('/') + files.first();
+    m_paths.insert(hash, fileName);
+    return fileName;
+}
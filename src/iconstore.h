@@ -0,0 +1,57 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef ICONSTORE_H
+#define ICONSTORE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QString>
+
+// Content addressed store of favicons, touch icons and page thumbnails used as
+// bookmark icons. Icons are referred to with image://browsericon/<hash> handles
+// instead of data urls. Encoded icons are kept on disk, decoded icons in a
+// memory LRU per requested size. Thread safe.
+class IconStore
+{
+public:
+    static IconStore *instance();
+
+    IconStore();
+
+    QString add(const QByteArray &data);
+    QString addDataUrl(const QString &dataUrl);
+
+    QImage image(const QString &hash, const QSize &requestedSize = QSize());
+    QString path(const QString &icon);
+
+    void clearMemory();
+    int memorySize() const;
+    void setDirectory(const QString &directory);
+
+    static bool isHandle(const QString &icon);
+    static bool isDataUrl(const QString &icon);
+    static QString hash(const QString &icon);
+
+private:
+    QString findPath(const QString &hash);
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    QHash<QString, QString> m_paths;
+    QCache<QString, QImage> m_images;
+};
+
+#endif // ICONSTORE_H
@@ -0,0 +1,181 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "internedurl.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+
+// Pool is squeezed when it has grown twice as big as after the previous squeeze.
+static const int gMinSqueezeLimit = 1024;
+
+class InternedUrlData : public QSharedData
+{
+public:
+    InternedUrlData(const QString &url, uint hash)
+        : url(url), hash(hash)
+    {
+    }
+
+    const QString url;
+    const uint hash;
+};
+
+struct UrlPool
+{
+    UrlPool() : squeezeLimit(gMinSqueezeLimit) {}
+
+    InternedUrlData *intern(const QString &url);
+    InternedUrlData *find(const QString &url, uint hash) const;
+    void squeeze();
+
+    QMutex mutex;
+    // Keyed by the cached hash so that the pool does not hold extra
+    // references to the url strings.
+    QMultiHash<uint, InternedUrlData *> urls;
+    int squeezeLimit;
+};
+
+Q_GLOBAL_STATIC(UrlPool, urlPool)
+
+InternedUrlData *UrlPool::intern(const QString &url)
+{
+    uint hash = qHash(url);
+    QMutexLocker locker(&mutex);
+    InternedUrlData *data = find(url, hash);
+    if (data) {
+        return data;
+    }
+
+    if (urls.count() >= squeezeLimit) {
+        squeeze();
+    }
+
+    data = new InternedUrlData(url, hash);
+    // Reference held by the pool.
+    data->ref.ref();
+    urls.insert(hash, data);
+    return data;
+}
+
+// Needs to be called with the mutex locked.
+InternedUrlData *UrlPool::find(const QString &url, uint hash) const
+{
+    QMultiHash<uint, InternedUrlData *>::const_iterator i = urls.constFind(hash);
+    while (i != urls.constEnd() && i.key() == hash) {
+        if (i.value()->url == url) {
+            return i.value();
+        }
+        ++i;
+    }
+    return 0;
+}
+
+void UrlPool::squeeze()
+{
+    QMultiHash<uint, InternedUrlData *>::iterator i = urls.begin();
+    while (i != urls.end()) {
+        InternedUrlData *data = i.value();
+        // Neither a handle nor a string copy refers to the url anymore. New handles
+        // are only created while holding the mutex, so the url cannot be revived.
+        if (data->ref.load() == 1 && data->url.isDetached()) {
+            i = urls.erase(i);
+            delete data;
+        } else {
+            ++i;
+        }
+    }
+    squeezeLimit = qMax(gMinSqueezeLimit, urls.count() * 2);
+}
+
+InternedUrl::InternedUrl()
+{
+}
+
+InternedUrl::InternedUrl(const QString &url)
+{
+    if (!url.isEmpty()) {
+        d = urlPool()->intern(url);
+    }
+}
+
+InternedUrl::InternedUrl(InternedUrlData *data)
+    : d(data)
+{
+}
+
+InternedUrl::InternedUrl(const InternedUrl &other)
+    : d(other.d)
+{
+}
+
+InternedUrl::~InternedUrl()
+{
+}
+
+InternedUrl &InternedUrl::operator=(const InternedUrl &other)
+{
+    d = other.d;
+    return *this;
+}
+
+QString InternedUrl::toString() const
+{
+    return d ? d->url : QString("");
+}
+
+bool InternedUrl::isEmpty() const
+{
+    return !d;
+}
+
+uint InternedUrl::hash() const
+{
+    return d ? d->hash : 0;
+}
+
+/**
+ * Returns the pooled \a url without adding it to the pool. Returns an empty
+ * handle if the url is not in the pool. Use for lookups, an url that is not
+ * in the pool cannot be equal to any existing handle.
+ */
+InternedUrl InternedUrl::find(const QString &url)
+{
+    if (url.isEmpty()) {
+        return InternedUrl();
+    }
+
+    uint hash = qHash(url);
+    UrlPool *pool = urlPool();
+    QMutexLocker locker(&pool->mutex);
+    // Handle takes its reference while the mutex is held, so that squeeze
+    // cannot drop the url in between.
+    return InternedUrl(pool->find(url, hash));
+}
+
+int InternedUrl::poolSize()
+{
+    UrlPool *pool = urlPool();
+    QMutexLocker locker(&pool->mutex);
+    return pool->urls.count();
+}
+
+/**
+ * Drops urls from the pool that are no longer referred to. The pool squeezes
+ * itself as it grows, calling this is needed only to release memory eagerly.
+ */
+void InternedUrl::squeeze()
+{
+    UrlPool *pool = urlPool();
+    QMutexLocker locker(&pool->mutex);
+    pool->squeeze();
+}
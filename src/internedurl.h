@@ -0,0 +1,69 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef INTERNEDURL_H
+#define INTERNEDURL_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QString>
+
+class InternedUrlData;
+
+// Handle to a url in the process wide url pool. Equal urls share one pooled
+// string, so handles compare by pointer and the hash of a url is calculated
+// only once, when it enters the pool. Empty urls are not pooled.
+class InternedUrl
+{
+public:
+    InternedUrl();
+    explicit InternedUrl(const QString &url);
+    InternedUrl(const InternedUrl &other);
+    ~InternedUrl();
+
+    InternedUrl &operator=(const InternedUrl &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    InternedUrl(InternedUrl &&other) : d(qMove(other.d)) {}
+    InternedUrl &operator=(InternedUrl &&other) { d.swap(other.d); return *this; }
+#endif
+
+    void swap(InternedUrl &other) { d.swap(other.d); }
+
+    QString toString() const;
+    bool isEmpty() const;
+    uint hash() const;
+
+    bool operator==(const InternedUrl &other) const { return d == other.d; }
+    bool operator!=(const InternedUrl &other) const { return d != other.d; }
+
+    static InternedUrl find(const QString &url);
+    static int poolSize();
+    static void squeeze();
+
+private:
+    explicit InternedUrl(InternedUrlData *data);
+
+    QExplicitlySharedDataPointer<InternedUrlData> d;
+};
+
+Q_DECLARE_SHARED(InternedUrl)
+
+inline uint qHash(const InternedUrl &url, uint seed = 0)
+{
+    return url.hash() ^ seed;
+}
+
+// Returns a copy of \a url that shares its storage with the pooled url.
+inline QString internUrl(const QString &url)
+{
+    return InternedUrl(url).toString();
+}
+
+#endif // INTERNEDURL_H
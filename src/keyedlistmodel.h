@@ -0,0 +1,273 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef KEYEDLISTMODEL_H
+#define KEYEDLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+
+#include "internedurl.h"
+
+// List model of items identified by their url. Item type T must provide
+// InternedUrl internedUrl() const. Items are stored by value in a contiguous
+// vector, with an url to row index next to it.
+template <typename T>
+class KeyedListModel : public QAbstractListModel
+{
+public:
+    explicit KeyedListModel(QObject *parent = 0)
+        : QAbstractListModel(parent)
+    {
+    }
+
+protected:
+    // Roles of a row that differ between oldItem and newItem of the same url.
+    virtual QVector<int> changedRoles(const T &oldItem, const T &newItem) const = 0;
+
+    void setItems(const QList<T> &items);
+    void clearItems();
+    void appendItem(const T &item);
+    void appendItems(const QList<T> &items);
+    void removeItem(int row);
+    void moveItem(int from, int to);
+    void replaceItem(int row, const T &item);
+    int row(const InternedUrl &url) const { return url.isEmpty() ? -1 : m_rows.value(url, -1); }
+
+    QVector<T> m_items;
+
+private:
+    template <typename Container>
+    static bool hasDuplicateUrls(const Container &items);
+    void updateRows(const QList<T> &items);
+    void updateRow(int row, const T &item);
+    void updateRowIndexes(int first, int last);
+
+    // Row of each url in m_items.
+    QHash<InternedUrl, int> m_rows;
+};
+
+/**
+ * Updates the model to contain \a items. Rows are matched by url, so that rows
+ * that still exist are kept, moved or updated instead of being reported changed
+ * position by position.
+ */
+template <typename T>
+void KeyedListModel<T>::setItems(const QList<T> &items)
+{
+    if (hasDuplicateUrls(items) || hasDuplicateUrls(m_items)) {
+        // Rows cannot be matched by url, fall back to a reset.
+        beginResetModel();
+        m_items = items.toVector();
+        endResetModel();
+    } else {
+        updateRows(items);
+    }
+
+    m_rows.clear();
+    m_rows.reserve(m_items.count());
+    for (int i = 0; i < m_items.count(); ++i) {
+        m_rows.insert(m_items.at(i).internedUrl(), i);
+    }
+}
+
+template <typename T>
+void KeyedListModel<T>::clearItems()
+{
+    beginResetModel();
+    m_items.clear();
+    m_rows.clear();
+    endResetModel();
+}
+
+/**
+ * Appends \a item, which must have an url that is not in the model yet.
+ */
+template <typename T>
+void KeyedListModel<T>::appendItem(const T &item)
+{
+    int row = m_items.count();
+    beginInsertRows(QModelIndex(), row, row);
+    m_items.append(item);
+    m_rows.insert(item.internedUrl(), row);
+    endInsertRows();
+}
+
+/**
+ * Appends \a items as one insertion. Items must have urls that are not in the
+ * model yet.
+ */
+template <typename T>
+void KeyedListModel<T>::appendItems(const QList<T> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    int first = m_items.count();
+    beginInsertRows(QModelIndex(), first, first + items.count() - 1);
+    m_items.reserve(first + items.count());
+    for (int i = 0; i < items.count(); ++i) {
+        m_items.append(items.at(i));
+        m_rows.insert(items.at(i).internedUrl(), first + i);
+    }
+    endInsertRows();
+}
+
+template <typename T>
+void KeyedListModel<T>::removeItem(int row)
+{
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.remove(m_items.at(row).internedUrl());
+    m_items.remove(row);
+    updateRowIndexes(row, m_items.count() - 1);
+    endRemoveRows();
+}
+
+/**
+ * Moves the item at row \a from so that it ends up at row \a to.
+ */
+template <typename T>
+void KeyedListModel<T>::moveItem(int from, int to)
+{
+    if (from == to) {
+        return;
+    }
+
+    // Destination of beginMoveRows() is a row before the move.
+    beginMoveRows(QModelIndex(), from, from, QModelIndex(), to > from ? to + 1 : to);
+    T item = m_items.at(from);
+    m_items.remove(from);
+    m_items.insert(to, item);
+    updateRowIndexes(qMin(from, to), qMax(from, to));
+    endMoveRows();
+}
+
+/**
+ * Replaces the item at \a row with \a item. The url may change, as long as
+ * the new url is not used by another row.
+ */
+template <typename T>
+void KeyedListModel<T>::replaceItem(int row, const T &item)
+{
+    InternedUrl oldUrl = m_items.at(row).internedUrl();
+    if (oldUrl != item.internedUrl()) {
+        m_rows.remove(oldUrl);
+        m_rows.insert(item.internedUrl(), row);
+    }
+    updateRow(row, item);
+}
+
+template <typename T>
+template <typename Container>
+bool KeyedListModel<T>::hasDuplicateUrls(const Container &items)
+{
+    QSet<InternedUrl> urls;
+    for (int i = 0; i < items.count(); ++i) {
+        InternedUrl url = items.at(i).internedUrl();
+        if (urls.contains(url)) {
+            return true;
+        }
+        urls.insert(url);
+    }
+    return false;
+}
+
+template <typename T>
+void KeyedListModel<T>::updateRows(const QList<T> &items)
+{
+    QSet<InternedUrl> newUrls;
+    newUrls.reserve(items.count());
+    for (int i = 0; i < items.count(); ++i) {
+        newUrls.insert(items.at(i).internedUrl());
+    }
+
+    // Remove rows that no longer exist, contiguous rows in one go.
+    int last = m_items.count() - 1;
+    while (last >= 0) {
+        if (newUrls.contains(m_items.at(last).internedUrl())) {
+            --last;
+            continue;
+        }
+
+        int first = last;
+        while (first > 0 && !newUrls.contains(m_items.at(first - 1).internedUrl())) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), first, last);
+        m_items.erase(m_items.begin() + first, m_items.begin() + last + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    // Remaining rows are all in items. Walk items and bring each row to its
+    // place by moving an existing row or inserting new rows.
+    QSet<InternedUrl> oldUrls;
+    oldUrls.reserve(m_items.count());
+    for (int i = 0; i < m_items.count(); ++i) {
+        oldUrls.insert(m_items.at(i).internedUrl());
+    }
+
+    int row = 0;
+    while (row < items.count()) {
+        const T &item = items.at(row);
+        if (row < m_items.count() && m_items.at(row).internedUrl() == item.internedUrl()) {
+            updateRow(row, item);
+            ++row;
+        } else if (oldUrls.contains(item.internedUrl())) {
+            int from = row + 1;
+            while (m_items.at(from).internedUrl() != item.internedUrl()) {
+                ++from;
+            }
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            T moved = m_items.at(from);
+            m_items.remove(from);
+            m_items.insert(row, moved);
+            endMoveRows();
+            updateRow(row, item);
+            ++row;
+        } else {
+            int end = row + 1;
+            while (end < items.count() && !oldUrls.contains(items.at(end).internedUrl())) {
+                ++end;
+            }
+            beginInsertRows(QModelIndex(), row, end - 1);
+            for (int i = row; i < end; ++i) {
+                m_items.insert(i, items.at(i));
+            }
+            endInsertRows();
+            row = end;
+        }
+    }
+}
+
+template <typename T>
+void KeyedListModel<T>::updateRow(int row, const T &item)
+{
+    QVector<int> roles = changedRoles(m_items.at(row), item);
+    m_items[row] = item;
+    if (!roles.isEmpty()) {
+        emit dataChanged(index(row), index(row), roles);
+    }
+}
+
+template <typename T>
+void KeyedListModel<T>::updateRowIndexes(int first, int last)
+{
+    for (int i = first; i <= last; ++i) {
+        m_rows[m_items.at(i).internedUrl()] = i;
+    }
+}
+
+#endif // KEYEDLISTMODEL_H
@@ -11,69 +11,102 @@
 
 #include "link.h"
 
+class LinkData : public QSharedData
+{
+public:
+    LinkData(int linkId, const InternedUrl &url, const QString &thumbPath, const QString &title)
+        : linkId(linkId), url(url), thumbPath(thumbPath), title(title)
+    {
+    }
+
+    int linkId;
+    InternedUrl url;
+    QString thumbPath;
+    QString title;
+};
+
 Link::Link(int linkId, QString urlString, QString thumbPath, QString title) :
-    m_linkId(linkId), m_url(urlString), m_thumbPath(thumbPath), m_title(title)
+    d(new LinkData(linkId, InternedUrl(urlString), thumbPath, title))
 {
 }
 
 Link::Link() :
-    m_linkId(0), m_url(""), m_thumbPath(""), m_title("")
+    d(new LinkData(0, InternedUrl(), QString(""), QString("")))
 {
 }
 
 Link::Link(const Link& l) :
-    m_linkId(l.m_linkId), m_url(l.m_url), m_thumbPath(l.m_thumbPath), m_title(l.m_title)
+    d(l.d)
+{
+}
+
+Link::~Link()
+{
+}
+
+Link &Link::operator=(const Link &other)
 {
+    d = other.d;
+    return *this;
 }
 
 int Link::linkId() const
 {
-    return m_linkId;
+    return d->linkId;
 }
 
 void Link::setLinkId(int linkId)
 {
-    m_linkId = linkId;
+    d->linkId = linkId;
 }
 
 QString Link::url() const
 {
-    return m_url;
+    return d->url.toString();
+}
+
+InternedUrl Link::internedUrl() const
+{
+    return d->url;
 }
 
 void Link::setUrl(const QString &url)
 {
-    m_url = url;
+    d->url = InternedUrl(url);
 }
 
 QString Link::thumbPath() const
 {
-    return m_thumbPath;
+    return d->thumbPath;
 }
 
 void Link::setThumbPath(const QString &thumbPath)
 {
-    m_thumbPath = thumbPath;
+    d->thumbPath = thumbPath;
 }
 
 QString Link::title() const
 {
-    return m_title;
+    return d->title;
 }
 
 void Link::setTitle(const QString &title)
 {
-    m_title = title;
+    d->title = title;
 }
 
 bool Link::isValid() const
 {
-    return m_linkId > 0 && m_url.length() > 0;
+    return d->linkId > 0 && !d->url.isEmpty();
 }
 
 bool Link::operator==(const Link &other) const
 {
-    return (m_linkId == other.linkId() && m_url == other.url() && m_thumbPath == other.thumbPath() && m_title == other.title());
+    if (d == other.d) {
+        return true;
+    }
+
+    return (d->linkId == other.linkId() && d->url == other.internedUrl() && d->thumbPath == other.thumbPath() && d->title == other.title());
 }
 
 bool Link::operator!=(const Link &other) const
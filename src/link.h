@@ -12,19 +12,36 @@
 #ifndef LINK_H
 #define LINK_H
 
+#include <QSharedDataPointer>
 #include <QString>
 
+#include "internedurl.h"
+
+class LinkData;
+
+// Implicitly shared. Copies, including the ones made when passing links
+// through queued signals, share the data until modified.
 class Link
 {
 public:
     explicit Link(int linkId, QString url, QString thumbPath, QString title);
     explicit Link();
     Link(const Link& l);
+    ~Link();
+
+    Link &operator=(const Link &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    Link(Link &&other) : d(qMove(other.d)) {}
+    Link &operator=(Link &&other) { d.swap(other.d); return *this; }
+#endif
+
+    void swap(Link &other) { d.swap(other.d); }
 
     int linkId() const;
     void setLinkId(int linkId);
 
     QString url() const;
+    InternedUrl internedUrl() const;
     void setUrl(const QString &url);
 
     QString thumbPath() const;
@@ -39,10 +56,9 @@ public:
     bool operator!=(const Link &other) const;
 
 private:
-    int m_linkId;
-    QString m_url;
-    QString m_thumbPath;
-    QString m_title;
+    QSharedDataPointer<LinkData> d;
 };
 
+Q_DECLARE_SHARED(Link)
+
 #endif // LINK_H
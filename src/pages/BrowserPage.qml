@@ -24,7 +24,7 @@ Page {
     property Component tabPageComponent
 
     property alias tabs: webView.tabModel
-    property alias history: historyModel
+    property alias history: suggestionModel
     property alias viewLoading: webView.loading
     property alias url: webView.url
     property alias title: webView.title
@@ -104,8 +104,12 @@ Page {
         }
     }
 
-    HistoryModel {
-        id: historyModel
+    SuggestionModel {
+        id: suggestionModel
+
+        tabModel: webView.tabModel
+        bookmarkModel: overlay.bookmarkModel
+        Component.onCompleted: search("")
     }
 
     Browser.DownloadRemorsePopup { id: downloadPopup }
@@ -138,7 +142,7 @@ Page {
 
         active: browserPage.status == PageStatus.Active
         webView: webView
-        historyModel: historyModel
+        historyModel: suggestionModel
         browserPage: browserPage
     }
 
@@ -193,7 +193,7 @@ SilicaGridView {
                     // We are still at same web page but no accepted touch icon. Let's grab thumbnail.
                     canDestroy = false
                     webPage.onThumbnailResult.connect(handleGrabbedThumbnail)
-                    webPage.grabThumbnail()
+                    webPage.grabThumbnail(Theme.iconSizeLauncher)
                 } else {
                     // Use default icon.
                     bookmarkModel.addBookmark(url, title || url, defaultIcon, false)
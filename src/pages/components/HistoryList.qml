@@ -17,6 +17,7 @@ SilicaListView {
     property string search
 
     signal load(string url, string title)
+    signal switchToTab(string url)
 
     // To prevent model to steal focus
     currentIndex: -1
@@ -55,7 +56,12 @@ SilicaListView {
 
         onClicked: {
             view.focus = true
-            view.load(model.url, model.title)
+            // Only open tabs have a tab id.
+            if (model.tabId) {
+                view.switchToTab(model.url)
+            } else {
+                view.load(model.url, model.title)
+            }
         }
     }
 
@@ -21,6 +21,7 @@ PanelBackground {
     property Item webView
     property Item browserPage
     property alias historyModel: historyList.model
+    property alias bookmarkModel: bookmarkModel
     property alias toolBar: toolBar
     property alias progressBar: progressBar
     property alias animator: overlayAnimator
@@ -32,6 +33,8 @@ PanelBackground {
             firstUseOverlay.done()
         }
 
+        preconnector.reset()
+
         if (url == "about:config") {
             pageStack.push(Qt.resolvedUrl("ConfigWarning.qml"), {"browserPage": browserPage});
         } else {
@@ -111,6 +114,13 @@ PanelBackground {
         when: dragArea.drag.active
     }
 
+    Preconnector {
+        id: preconnector
+
+        // Top suggestion while the user is typing.
+        candidate: searchField.edited && historyList.visible ? historyModel.topUrl : ""
+    }
+
     // This is an invisible object responsible to hide/show Overlay in an animated way
     Browser.OverlayAnimator {
         id: overlayAnimator
@@ -367,6 +377,13 @@ PanelBackground {
                 onMovingChanged: if (moving) historyList.focus = true
                 onSearchChanged: if (search !== webView.url) historyModel.search(search)
                 onLoad: overlay.loadPage(url, title)
+                onSwitchToTab: {
+                    if (webView.tabModel.activateTab(url)) {
+                        overlay.dismiss()
+                    } else {
+                        overlay.loadPage(url, "")
+                    }
+                }
 
                 Behavior on opacity { FadeAnimation {} }
             }
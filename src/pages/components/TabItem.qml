@@ -52,10 +52,12 @@ BackgroundItem {
         Image {
             id: image
 
-            readonly property bool active: source != ""
+            readonly property bool active: source != "" && status === Image.Ready
 
-            source: !activeTab ? thumbnailPath : ""
-            cache: false
+            source: !activeTab ? thumbnailSource : ""
+            // Decoded once at cell size. Delegates of the same thumbnail share the
+            // texture, and animating the delegate size does not reload it.
+            sourceSize.width: view ? view.cellWidth : root.width
             visible: false
             asynchronous: true
             smooth: true
@@ -66,39 +68,38 @@ BackgroundItem {
             height: root.implicitHeight
             live: !destroying
             visible: false
-            sourceItem: activeTab ? activeWebPage : (image.active ? image : contentItem)
-            sourceRect: Qt.rect(0, 0, mask.width, mask.height)
-        },
-        ShaderEffectSource {
-            id: mask
-            anchors.fill: contentItem
-            live: textureSource.live
-            hideSource: true
-            visible: false
-            sourceItem: Rectangle {
-                x: contentItem.x
-                y: contentItem.y
-                width: contentItem.width
-                height: contentItem.height
-                radius: contentItem.radius
-                color: "white"
-            }
+            // Thumbnail textures are used as such, only the live page of the active tab
+            // and the placeholder background are rendered offscreen.
+            sourceItem: activeTab ? activeWebPage : (image.active ? null : contentItem)
+            sourceRect: Qt.rect(0, 0, contentItem.width, contentItem.height)
         },
         ShaderEffect {
             id: roundingItem
-            property variant source: textureSource
-            property variant maskSource: mask
+            property variant source: !activeTab && image.active ? image : textureSource
+            property size sourceScale: source === image
+                                       ? Qt.size(width / Math.max(image.width, 1), height / Math.max(image.height, 1))
+                                       : Qt.size(1, 1)
+            property size itemSize: Qt.size(width, height)
+            property real radius: contentItem.radius
 
-            anchors.fill: mask
+            anchors.fill: contentItem
             smooth: true
 
+            // Rounded corners are computed instead of sampling a mask texture.
             fragmentShader: "
                 varying highp vec2 qt_TexCoord0;
                 uniform highp float qt_Opacity;
                 uniform lowp sampler2D source;
-                uniform lowp sampler2D maskSource;
+                uniform highp vec2 sourceScale;
+                uniform highp vec2 itemSize;
+                uniform highp float radius;
                 void main(void) {
-                    gl_FragColor = texture2D(source, qt_TexCoord0.st) * (texture2D(maskSource, qt_TexCoord0.st).a) * qt_Opacity;
+                    highp vec2 coord = qt_TexCoord0 * sourceScale;
+                    highp vec2 position = qt_TexCoord0 * itemSize;
+                    highp vec2 center = clamp(position, vec2(radius), itemSize - vec2(radius));
+                    lowp float alpha = clamp(radius + 0.5 - distance(position, center), 0.0, 1.0);
+                    alpha *= step(coord.x, 1.0) * step(coord.y, 1.0);
+                    gl_FragColor = texture2D(source, coord) * alpha * qt_Opacity;
                 }"
         },
         OpacityRampEffect {
@@ -109,7 +110,7 @@ BackgroundItem {
             enabled: Qt.application.active
 
             sourceItem: roundingItem
-            anchors.fill: mask
+            anchors.fill: roundingItem
             direction: OpacityRamp.TopToBottom
         },
         IconButton {
@@ -117,7 +118,7 @@ BackgroundItem {
 
             visible: ramp.enabled
             anchors {
-                left: mask.left
+                left: roundingItem.left
                 bottom: parent.bottom
                 bottomMargin: -root.bottomMargin
             }
@@ -146,7 +147,7 @@ BackgroundItem {
         Label {
             anchors {
                 left: close.right
-                right: mask.right
+                right: roundingItem.right
                 rightMargin: Theme.paddingMedium
                 verticalCenter: close.verticalCenter
             }
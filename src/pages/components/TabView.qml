@@ -30,6 +30,8 @@ SilicaGridView {
     width: parent.width
     height: parent.height
     currentIndex: -1
+    // Thumbnails of rows just outside the view are decoded ahead of scrolling.
+    cacheBuffer: cellHeight * 2
     header: spacer
     footer: spacer
     // If approved to Silica, remove these transitions from browser.
@@ -110,7 +110,6 @@ WebContainer {
             width: container.width
             state: ""
 
-            onClearGrabResult: tabs.updateThumbnailPath(tabId, "");
             onGrabResult: tabs.updateThumbnailPath(tabId, fileName);
 
             onUrlChanged: {
@@ -305,6 +304,26 @@ WebContainer {
         }
     }
 
+    Image {
+        id: placeholder
+
+        x: webView.placeholderRect.x
+        y: webView.placeholderRect.y
+        z: 1
+        width: webView.placeholderRect.width
+        height: implicitWidth > 0 ? width * implicitHeight / implicitWidth : 0
+        source: webView.placeholderSource
+        asynchronous: true
+        opacity: webView.placeholderVisible && status === Image.Ready ? 1.0 : 0.0
+        visible: opacity > 0
+
+        // Shown at once, cross-fades to the page once it has painted.
+        Behavior on opacity {
+            enabled: !webView.placeholderVisible
+            FadeAnimation {}
+        }
+    }
+
     Rectangle {
         id: verticalScrollDecorator
 
@@ -0,0 +1,214 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "preconnector.h"
+
+#include <MGConfItem>
+#include <QNetworkConfiguration>
+#include <QUrl>
+#include <QVariantMap>
+#include <qmozcontext.h>
+
+#ifndef DEBUG_LOGS
+#define DEBUG_LOGS 0
+#endif
+
+#if DEBUG_LOGS
+#include <QDebug>
+#endif
+
+static const int gDefaultDwellTime = 300;
+// Time a speculative connection is expected to stay open in the engine if it
+// is not used. No new speculation is started meanwhile.
+static const int gConnectionHoldTime = 10000;
+
+Preconnector::Preconnector(QObject *parent)
+    : QObject(parent)
+    , m_enabled(false)
+    , m_metered(false)
+{
+    m_enabledConfItem = new MGConfItem("/apps/sailfish-browser/settings/speculative_connect", this);
+    connect(m_enabledConfItem, SIGNAL(valueChanged()), this, SLOT(updateEnabled()));
+    updateEnabled();
+
+    connect(&m_networkManager, SIGNAL(onlineStateChanged(bool)), this, SLOT(updateMetered()));
+    connect(&m_networkManager, SIGNAL(configurationChanged(QNetworkConfiguration)), this, SLOT(updateMetered()));
+    updateMetered();
+
+    m_dwellTimer.setSingleShot(true);
+    m_dwellTimer.setInterval(gDefaultDwellTime);
+    connect(&m_dwellTimer, SIGNAL(timeout()), this, SLOT(dwellTimeout()));
+
+    m_connectionTimer.setSingleShot(true);
+    m_connectionTimer.setInterval(gConnectionHoldTime);
+    connect(&m_connectionTimer, SIGNAL(timeout()), this, SLOT(releaseConnection()));
+}
+
+bool Preconnector::enabled() const
+{
+    return m_enabled;
+}
+
+void Preconnector::setEnabled(bool enabled)
+{
+    if (m_enabled != enabled) {
+        m_enabled = enabled;
+        if (!m_enabled) {
+            m_dwellTimer.stop();
+        }
+        emit enabledChanged();
+    }
+}
+
+QString Preconnector::candidate() const
+{
+    return m_candidate;
+}
+
+/**
+ * Sets the url that is currently the top suggestion. The dwell time restarts
+ * whenever the origin of the candidate changes.
+ */
+void Preconnector::setCandidate(const QString &candidate)
+{
+    if (m_candidate == candidate) {
+        return;
+    }
+
+    bool sameOrigin = origin(m_candidate) == origin(candidate);
+    m_candidate = candidate;
+    if (!sameOrigin) {
+        m_dwellTimer.stop();
+        if (m_enabled && !origin(m_candidate).isEmpty()) {
+            m_dwellTimer.start();
+        }
+    }
+    emit candidateChanged();
+}
+
+int Preconnector::dwellTime() const
+{
+    return m_dwellTimer.interval();
+}
+
+void Preconnector::setDwellTime(int dwellTime)
+{
+    if (m_dwellTimer.interval() != dwellTime) {
+        m_dwellTimer.setInterval(dwellTime);
+        emit dwellTimeChanged();
+    }
+}
+
+bool Preconnector::metered() const
+{
+    return m_metered;
+}
+
+/**
+ * Forgets the speculative connection, e.g. after a page load has been started
+ * and the connection has either been used or become useless.
+ */
+void Preconnector::reset()
+{
+    m_dwellTimer.stop();
+    m_connectionTimer.stop();
+    m_connectedOrigin.clear();
+}
+
+/**
+ * Returns scheme, host and port of \a url, or an empty string if the url is not
+ * an http or https url.
+ */
+QString Preconnector::origin(const QString &url)
+{
+    QUrl parsed(url);
+    QString scheme = parsed.scheme();
+    if ((scheme != QLatin1String("http") && scheme != QLatin1String("https")) || parsed.host().isEmpty()) {
+        return QString();
+    }
+    return parsed.toString(QUrl::RemovePath | QUrl::RemoveQuery | QUrl::RemoveFragment | QUrl::RemoveUserInfo);
+}
+
+void Preconnector::updateEnabled()
+{
+    setEnabled(m_enabledConfItem->value(false).toBool());
+}
+
+void Preconnector::updateMetered()
+{
+    QNetworkConfiguration configuration = m_networkManager.defaultConfiguration();
+    switch (configuration.bearerTypeFamily()) {
+    case QNetworkConfiguration::Bearer2G:
+    case QNetworkConfiguration::Bearer3G:
+    case QNetworkConfiguration::Bearer4G:
+        setMetered(true);
+        break;
+    default:
+        setMetered(false);
+        break;
+    }
+}
+
+void Preconnector::setMetered(bool metered)
+{
+    if (m_metered != metered) {
+        m_metered = metered;
+        if (m_metered) {
+            m_dwellTimer.stop();
+        }
+        emit meteredChanged();
+    }
+}
+
+void Preconnector::dwellTimeout()
+{
+    QString candidateOrigin = origin(m_candidate);
+    if (!m_enabled || m_metered || candidateOrigin.isEmpty()) {
+        return;
+    }
+
+    QMozContext *mozContext = QMozContext::GetInstance();
+    if (!mozContext->initialized()) {
+        return;
+    }
+
+    // One speculative connection at a time.
+    if (!m_connectedOrigin.isEmpty()) {
+#if DEBUG_LOGS
+        qDebug() << "skipping" << candidateOrigin << "connection to" << m_connectedOrigin << "still held";
+#endif
+        return;
+    }
+
+    QVariantMap data;
+    data.insert("uri", candidateOrigin);
+    data.insert("dnsPrefetch", true);
+    data.insert("preconnect", true);
+    mozContext->sendObserve("embedui:speculativeconnect", QVariant(data));
+
+    m_connectedOrigin = candidateOrigin;
+    m_connectionTimer.start();
+    emit preconnected(candidateOrigin);
+}
+
+void Preconnector::releaseConnection()
+{
+    QString releasedOrigin = m_connectedOrigin;
+    m_connectionTimer.stop();
+    m_connectedOrigin.clear();
+
+    // Candidate may have dwelled while the connection was held.
+    QString candidateOrigin = origin(m_candidate);
+    if (m_enabled && !candidateOrigin.isEmpty() && candidateOrigin != releasedOrigin
+            && !m_dwellTimer.isActive()) {
+        m_dwellTimer.start();
+    }
+}
@@ -0,0 +1,80 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef PRECONNECTOR_H
+#define PRECONNECTOR_H
+
+#include <QObject>
+#include <QNetworkConfigurationManager>
+#include <QString>
+#include <QTimer>
+
+class MGConfItem;
+
+// Asks the engine to resolve and connect to the origin of the top url suggestion
+// once it has stayed on top for the dwell time. Off unless enabled in settings.
+class Preconnector : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ enabled WRITE setEnabled NOTIFY enabledChanged FINAL)
+    Q_PROPERTY(QString candidate READ candidate WRITE setCandidate NOTIFY candidateChanged FINAL)
+    Q_PROPERTY(int dwellTime READ dwellTime WRITE setDwellTime NOTIFY dwellTimeChanged FINAL)
+    Q_PROPERTY(bool metered READ metered NOTIFY meteredChanged FINAL)
+
+public:
+    explicit Preconnector(QObject *parent = 0);
+
+    bool enabled() const;
+    void setEnabled(bool enabled);
+
+    QString candidate() const;
+    void setCandidate(const QString &candidate);
+
+    int dwellTime() const;
+    void setDwellTime(int dwellTime);
+
+    bool metered() const;
+
+    Q_INVOKABLE void reset();
+
+    static QString origin(const QString &url);
+
+signals:
+    void enabledChanged();
+    void candidateChanged();
+    void dwellTimeChanged();
+    void meteredChanged();
+    void preconnected(QString origin);
+
+private slots:
+    void updateEnabled();
+    void updateMetered();
+    void dwellTimeout();
+    void releaseConnection();
+
+private:
+    void setMetered(bool metered);
+
+    MGConfItem *m_enabledConfItem;
+    QNetworkConfigurationManager m_networkManager;
+    bool m_enabled;
+    bool m_metered;
+    QString m_candidate;
+    QTimer m_dwellTimer;
+
+    // Origin of the speculative connection that may still be open.
+    QString m_connectedOrigin;
+    QTimer m_connectionTimer;
+
+    friend class tst_preconnector;
+};
+
+#endif // PRECONNECTOR_H
@@ -32,12 +32,18 @@
 #include "closeeventfilter.h"
 #include "declarativetabmodel.h"
 #include "declarativehistorymodel.h"
+#include "declarativesuggestionmodel.h"
 #include "declarativewebcontainer.h"
 #include "declarativewebpage.h"
 #include "declarativewebviewcreator.h"
 #include "declarativefileuploadmode.h"
 #include "declarativefileuploadfilter.h"
 #include "iconfetcher.h"
+#include "iconimageprovider.h"
+#include "preconnector.h"
+#include "thumbnailcache.h"
+#include "thumbnailimageprovider.h"
+#include "webpagetrace.h"
 
 #ifdef HAS_BOOSTER
 #include <MDeclarativeCache>
@@ -123,6 +129,7 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     qmlRegisterType<DeclarativeBookmarkModel>("Sailfish.Browser", 1, 0, "BookmarkModel");
     qmlRegisterType<DeclarativeTabModel>("Sailfish.Browser", 1, 0, "TabModel");
     qmlRegisterType<DeclarativeHistoryModel>("Sailfish.Browser", 1, 0, "HistoryModel");
+    qmlRegisterType<DeclarativeSuggestionModel>("Sailfish.Browser", 1, 0, "SuggestionModel");
     qmlRegisterType<DeclarativeWebContainer>("Sailfish.Browser", 1, 0, "WebContainer");
     qmlRegisterType<DeclarativeWebPage>("Sailfish.Browser", 1, 0, "WebPage");
     qmlRegisterType<DeclarativeWebViewCreator>("Sailfish.Browser", 1, 0, "WebViewCreator");
@@ -130,6 +137,7 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     qmlRegisterType<DeclarativeFileUploadFilter>("Sailfish.Browser", 1, 0, "FileUploadFilter");
     qmlRegisterType<DesktopBookmarkWriter>("Sailfish.Browser", 1, 0, "DesktopBookmarkWriter");
     qmlRegisterType<IconFetcher>("Sailfish.Browser", 1, 0, "IconFetcher");
+    qmlRegisterType<Preconnector>("Sailfish.Browser", 1, 0, "Preconnector");
 
     QString componentPath(DEFAULT_COMPONENTS_PATH);
     QMozContext::GetInstance()->addComponentManifest(componentPath + QString("/components/EmbedLiteBinComponents.manifest"));
@@ -146,11 +154,20 @@ Q_DECL_EXPORT int main(int argc, char *argv[])
     utils->connect(service, SIGNAL(dumpMemoryInfoRequested(QString)),
                    utils, SLOT(handleDumpMemoryInfoRequest(QString)));
 
+    // Tab lifecycle trace in Chrome trace event format, see WebPageTrace.
+    QObject::connect(service, SIGNAL(dumpTabTraceRequested(QString)),
+                     WebPageTrace::instance(), SLOT(writeChromeTrace(QString)));
+
     utils->clearStartupCacheIfNeeded();
     view->rootContext()->setContextProperty("WebUtils", utils);
     view->rootContext()->setContextProperty("MozContext", QMozContext::GetInstance());
     view->rootContext()->setContextProperty("Settings", SettingManager::instance());
 
+    // Tab grid thumbnails are shown in full screen width.
+    ThumbnailCache::instance()->setVariantWidth(ThumbnailCache::GridVariant, app->primaryScreen()->size().width());
+    view->engine()->addImageProvider(QLatin1String("thumbnail"), new ThumbnailImageProvider);
+    view->engine()->addImageProvider(QLatin1String("browsericon"), new IconImageProvider);
+
     DownloadManager *dlMgr = DownloadManager::instance();
     dlMgr->connect(service, SIGNAL(cancelTransferRequested(int)),
             dlMgr, SLOT(cancelTransfer(int)));
@@ -1,4 +1,4 @@
-QT += qml quick dbus concurrent sql
+QT += qml quick dbus concurrent sql network
 # The name of your app
 TARGET = sailfish-browser
 
@@ -59,6 +59,7 @@ include(bookmarks.pri)
 # C++ sources
 SOURCES += \
     sailfishbrowser.cpp \
+    blackframe.cpp \
     declarativewebcontainer.cpp \
     declarativewebpage.cpp \
     declarativewebutils.cpp \
@@ -67,13 +68,19 @@ SOURCES += \
     dbusadaptor.cpp \
     downloadmanager.cpp \
     iconfetcher.cpp \
+    iconimageprovider.cpp \
     settingmanager.cpp \
     closeeventfilter.cpp \
+    preconnector.cpp \
+    thumbnailimageprovider.cpp \
+    backforwardcache.cpp \
     webpagequeue.cpp \
-    webpages.cpp
+    webpages.cpp \
+    webpagetrace.cpp
 
 # C++ headers
 HEADERS += \
+    blackframe.h \
     declarativewebcontainer.h \
     declarativewebpage.h \
     declarativewebutils.h \
@@ -82,10 +89,15 @@ HEADERS += \
     dbusadaptor.h \
     downloadmanager.h \
     iconfetcher.h \
+    iconimageprovider.h \
     settingmanager.h \
     closeeventfilter.h \
+    preconnector.h \
+    thumbnailimageprovider.h \
+    backforwardcache.h \
     webpagequeue.h \
     webpages.h \
+    webpagetrace.h \
     declarativefileuploadmode.h \
     declarativefileuploadfilter.h
 
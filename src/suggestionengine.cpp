@@ -0,0 +1,346 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "suggestionengine.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+
+#include <sqlite3.h>
+
+#ifndef DEBUG_LOGS
+#define DEBUG_LOGS 0
+#endif
+
+static const int gMaxSuggestions = 20;
+// How often the latency budget is checked while matching snapshots.
+static const int gBudgetCheckInterval = 64;
+// Virtual machine instructions between latency budget checks of the history query.
+static const int gProgressInterval = 1000;
+
+// Scores of the best match of the entered text, see SuggestionEngine::score().
+static const int gUrlPrefixScore = 100;
+static const int gTitleWordScore = 80;
+static const int gUrlScore = 60;
+static const int gTitleScore = 40;
+static const int gRecentScore = 10;
+
+static const int gTabBonus = 15;
+static const int gBookmarkBonus = 10;
+static const int gMaxVisitBonus = 10;
+
+Suggestion::Suggestion()
+    : source(HistorySource)
+    , tabId(0)
+    , visitCount(0)
+    , score(0)
+{
+}
+
+Suggestion::Suggestion(Source source, const QString &url, const QString &title, int tabId)
+    : source(source)
+    , url(url)
+    , title(title)
+    , tabId(tabId)
+    , visitCount(0)
+    , score(0)
+{
+}
+
+static QString stripScheme(const QString &url)
+{
+    int start = url.indexOf(QLatin1String("://"));
+    start = start < 0 ? 0 : start + 3;
+    if (url.midRef(start, 4) == QLatin1String("www.")) {
+        start += 4;
+    }
+    return url.mid(start);
+}
+
+static bool higherScore(const Suggestion &a, const Suggestion &b)
+{
+    return a.score > b.score;
+}
+
+SuggestionEngine::SuggestionEngine(QObject *parent)
+    : QObject(parent)
+    , m_sqlite(0)
+    , m_latestQuery(0)
+    , m_queryId(0)
+    , m_latencyBudget(0)
+{
+}
+
+SuggestionEngine::~SuggestionEngine()
+{
+    if (m_database.isOpen()) {
+        QString connectionName = m_database.connectionName();
+        m_database.close();
+        m_database = QSqlDatabase();
+        QSqlDatabase::removeDatabase(connectionName);
+    }
+}
+
+void SuggestionEngine::supersede(int queryId)
+{
+    m_latestQuery.store(queryId);
+}
+
+/**
+ * Returns how well \a suggestion matches \a filter, or 0 if it does not match.
+ * Url prefix matches ignoring the scheme and "www." rank highest, followed by
+ * matches at the beginning of a word of the title. Open tabs and bookmarks
+ * rank above history entries with an equal match.
+ */
+int SuggestionEngine::score(const Suggestion &suggestion, const QString &filter)
+{
+    int score = 0;
+    if (filter.isEmpty()) {
+        score = gRecentScore;
+    } else {
+        QString url = suggestion.url.toString();
+        if (stripScheme(url).startsWith(filter, Qt::CaseInsensitive)) {
+            score = gUrlPrefixScore;
+        } else {
+            int index = suggestion.title.indexOf(filter, 0, Qt::CaseInsensitive);
+            if (index == 0 || (index > 0 && !suggestion.title.at(index - 1).isLetterOrNumber())) {
+                score = gTitleWordScore;
+            } else if (url.contains(filter, Qt::CaseInsensitive)) {
+                score = gUrlScore;
+            } else if (index > 0) {
+                score = gTitleScore;
+            }
+        }
+    }
+
+    if (score == 0) {
+        return 0;
+    }
+
+    switch (suggestion.source) {
+    case Suggestion::TabSource:
+        return score + gTabBonus;
+    case Suggestion::BookmarkSource:
+        return score + gBookmarkBonus;
+    case Suggestion::HistorySource:
+        return score + qMin(suggestion.visitCount, gMaxVisitBonus);
+    }
+    return score;
+}
+
+void SuggestionEngine::setTabs(QList<Suggestion> tabs)
+{
+    m_tabs = tabs;
+}
+
+void SuggestionEngine::setBookmarks(QList<Suggestion> bookmarks)
+{
+    m_bookmarks = bookmarks;
+}
+
+/**
+ * Matches \a filter against all sources, cheapest first. If matching takes longer
+ * than \a latencyBudget milliseconds, the results found so far are emitted as
+ * partial. Nothing is emitted if a newer query has been issued meanwhile.
+ */
+void SuggestionEngine::query(int queryId, QString filter, int latencyBudget)
+{
+    if (superseded(queryId)) {
+        return;
+    }
+
+    m_elapsed.start();
+    m_queryId = queryId;
+    m_latencyBudget = latencyBudget;
+    m_results.clear();
+    m_resultIndex.clear();
+
+    filter = filter.trimmed();
+    bool complete = true;
+    // Without a filter only recent history is suggested.
+    if (!filter.isEmpty()) {
+        complete = matchSnapshot(m_tabs, filter, queryId)
+                && matchSnapshot(m_bookmarks, filter, queryId);
+    }
+
+    if (complete) {
+        complete = matchHistory(filter, queryId);
+    }
+
+    if (superseded(queryId)) {
+        return;
+    }
+
+#if DEBUG_LOGS
+    qDebug() << "query:" << queryId << filter << "results:" << m_results.count()
+             << "partial:" << !complete << m_elapsed.elapsed() << "ms";
+#endif
+
+    emit suggestionsAvailable(queryId, results(), !complete);
+    m_results.clear();
+    m_resultIndex.clear();
+}
+
+bool SuggestionEngine::matchSnapshot(const QList<Suggestion> &snapshot, const QString &filter, int queryId)
+{
+    for (int i = 0; i < snapshot.count(); ++i) {
+        if (i % gBudgetCheckInterval == 0 && interrupted(queryId)) {
+            return false;
+        }
+
+        Suggestion suggestion = snapshot.at(i);
+        suggestion.score = score(suggestion, filter);
+        if (suggestion.score > 0) {
+            add(suggestion);
+        }
+    }
+    return !interrupted(queryId);
+}
+
+bool SuggestionEngine::matchHistory(const QString &filter, int queryId)
+{
+    if (!openDatabase()) {
+        return true;
+    }
+
+    // Same selection as DBWorker::getHistory, visit count is used for ranking.
+    QString filterQuery("WHERE (NULLIF(title, '') IS NOT NULL AND url NOT LIKE 'about:%' AND %1) ");
+    QString order;
+    if (!filter.isEmpty()) {
+        filterQuery = filterQuery.arg(QString("(url LIKE :search OR title LIKE :search)"));
+        order = QString("LENGTH(url), title, date ASC");
+    } else {
+        filterQuery = filterQuery.arg(1);
+        order = QString("date DESC");
+    }
+
+    QSqlQuery query(m_database);
+    query.prepare(QString("SELECT url, title, visited_count "
+                          "FROM browser_history "
+                          "%1"
+                          "ORDER BY %2 LIMIT %3;").arg(filterQuery).arg(order).arg(gMaxSuggestions));
+    if (!filter.isEmpty()) {
+        query.bindValue(QString(":search"), QString("%%1%").arg(filter));
+    }
+
+    // Scanning history is the slow part. SQLite checks the latency budget
+    // also while the query runs and aborts it once the budget is used up.
+    if (m_sqlite) {
+        sqlite3_progress_handler(m_sqlite, gProgressInterval, &SuggestionEngine::progress, this);
+    }
+
+    bool complete = true;
+    if (query.exec()) {
+        while (query.next()) {
+            Suggestion suggestion(Suggestion::HistorySource, query.value(0).toString(), query.value(1).toString());
+            suggestion.visitCount = query.value(2).toInt();
+            suggestion.score = score(suggestion, filter);
+            if (suggestion.score > 0) {
+                add(suggestion);
+            }
+        }
+    }
+
+    if (interrupted(queryId)) {
+        complete = false;
+    } else if (query.lastError().isValid()) {
+        qWarning() << "Suggestion query failed:" << query.lastError();
+    }
+
+    if (m_sqlite) {
+        sqlite3_progress_handler(m_sqlite, 0, 0, 0);
+    }
+    return complete;
+}
+
+bool SuggestionEngine::openDatabase()
+{
+    if (m_database.isOpen()) {
+        return true;
+    }
+
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::DataLocation));
+    QString dbFileName = dir.absoluteFilePath(QLatin1String(DB_NAME));
+    // Database is created by DBWorker.
+    if (!QFile::exists(dbFileName)) {
+        return false;
+    }
+
+    if (!m_database.isValid()) {
+        m_database = QSqlDatabase::addDatabase("QSQLITE", QString("suggestions-%1").arg((quintptr)this));
+        m_database.setDatabaseName(dbFileName);
+        m_database.setConnectOptions("QSQLITE_OPEN_READONLY");
+    }
+
+    if (!m_database.open()) {
+        qWarning() << "Failed to open database for suggestions" << m_database.lastError();
+        return false;
+    }
+
+    QVariant handle = m_database.driver()->handle();
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        m_sqlite = *static_cast<sqlite3 **>(handle.data());
+    }
+    return true;
+}
+
+bool SuggestionEngine::superseded(int queryId) const
+{
+    return queryId != m_latestQuery.load();
+}
+
+/**
+ * Returns true if a newer query has been issued or the latency budget of the
+ * current query has been used up.
+ */
+bool SuggestionEngine::interrupted(int queryId) const
+{
+    return superseded(queryId) || m_elapsed.elapsed() > m_latencyBudget;
+}
+
+// Progress handler of SQLite. Returning non-zero interrupts the running query.
+int SuggestionEngine::progress(void *engine)
+{
+    SuggestionEngine *suggestionEngine = static_cast<SuggestionEngine *>(engine);
+    return suggestionEngine->interrupted(suggestionEngine->m_queryId) ? 1 : 0;
+}
+
+void SuggestionEngine::add(Suggestion suggestion)
+{
+    // Same url from several sources is suggested once. Open tab wins over
+    // bookmark and bookmark over history, as the score bonus does.
+    int index = m_resultIndex.value(suggestion.url, -1);
+    if (index < 0) {
+        m_resultIndex.insert(suggestion.url, m_results.count());
+        m_results.append(suggestion);
+        return;
+    }
+
+    Suggestion &existing = m_results[index];
+    if (suggestion.score > existing.score) {
+        existing.score = suggestion.score;
+    }
+    if (existing.title.isEmpty()) {
+        existing.title = suggestion.title;
+    }
+}
+
+QList<Suggestion> SuggestionEngine::results() const
+{
+    QList<Suggestion> results = m_results;
+    qStableSort(results.begin(), results.end(), higherScore);
+    return results.mid(0, gMaxSuggestions);
+}
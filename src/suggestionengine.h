@@ -0,0 +1,101 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SUGGESTIONENGINE_H
+#define SUGGESTIONENGINE_H
+
+#include <QObject>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QMetaType>
+#include <QSqlDatabase>
+#include <QString>
+
+#include "internedurl.h"
+
+struct sqlite3;
+
+struct Suggestion
+{
+    enum Source {
+        TabSource,
+        BookmarkSource,
+        HistorySource
+    };
+
+    Suggestion();
+    Suggestion(Source source, const QString &url, const QString &title, int tabId = 0);
+
+    InternedUrl internedUrl() const { return url; }
+
+    Source source;
+    InternedUrl url;
+    QString title;
+    int tabId;
+    // Visits of a history entry.
+    int visitCount;
+    int score;
+};
+
+Q_DECLARE_METATYPE(Suggestion)
+Q_DECLARE_METATYPE(QList<Suggestion>)
+
+// Matches the entered text against open tabs, bookmarks and history. Runs on a
+// worker thread of DeclarativeSuggestionModel. Tabs and bookmarks are matched
+// against snapshots, history is queried through a read-only connection of its own.
+class SuggestionEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SuggestionEngine(QObject *parent = 0);
+    ~SuggestionEngine();
+
+    // Thread safe. Queries older than queryId are abandoned.
+    void supersede(int queryId);
+
+    static int score(const Suggestion &suggestion, const QString &filter);
+
+public slots:
+    void setTabs(QList<Suggestion> tabs);
+    void setBookmarks(QList<Suggestion> bookmarks);
+    void query(int queryId, QString filter, int latencyBudget);
+
+signals:
+    void suggestionsAvailable(int queryId, QList<Suggestion> suggestions, bool partial);
+
+private:
+    bool matchSnapshot(const QList<Suggestion> &snapshot, const QString &filter, int queryId);
+    bool matchHistory(const QString &filter, int queryId);
+    bool openDatabase();
+    bool superseded(int queryId) const;
+    bool interrupted(int queryId) const;
+    static int progress(void *engine);
+    void add(Suggestion suggestion);
+    QList<Suggestion> results() const;
+
+    QSqlDatabase m_database;
+    sqlite3 *m_sqlite;
+    QList<Suggestion> m_tabs;
+    QList<Suggestion> m_bookmarks;
+    QAtomicInt m_latestQuery;
+
+    // State of the query being processed.
+    int m_queryId;
+    QHash<InternedUrl, int> m_resultIndex;
+    QList<Suggestion> m_results;
+    QElapsedTimer m_elapsed;
+    int m_latencyBudget;
+};
+
+#endif // SUGGESTIONENGINE_H
@@ -11,97 +11,135 @@
 
 #include "tab.h"
 
+class TabData : public QSharedData
+{
+public:
+    TabData(int tabId, const Link &currentLink, int nextLinkId, int previousLinkId)
+        : tabId(tabId), currentLink(currentLink), nextLinkId(nextLinkId), previousLinkId(previousLinkId)
+    {
+    }
+
+    int tabId;
+    Link currentLink;
+    int nextLinkId;
+    int previousLinkId;
+};
+
 Tab::Tab(int tabId, Link currentLink, int nextLinkId, int previousLinkId) :
-    m_tabId(tabId), m_currentLink(currentLink), m_nextLinkId(nextLinkId), m_previousLinkId(previousLinkId)
+    d(new TabData(tabId, currentLink, nextLinkId, previousLinkId))
 {
 }
 
 Tab::Tab() :
-    m_tabId(0), m_nextLinkId(0), m_previousLinkId(0)
+    d(new TabData(0, Link(), 0, 0))
+{
+}
+
+Tab::Tab(const Tab &other) :
+    d(other.d)
+{
+}
+
+Tab::~Tab()
 {
 }
 
+Tab &Tab::operator=(const Tab &other)
+{
+    d = other.d;
+    return *this;
+}
+
 int Tab::tabId() const
 {
-    return m_tabId;
+    return d->tabId;
 }
 
 void Tab::setTabId(int tabId)
 {
-    m_tabId = tabId;
+    d->tabId = tabId;
 }
 
 int Tab::currentLink() const
 {
-    return m_currentLink.linkId();
+    return d->currentLink.linkId();
 }
 
 void Tab::setCurrentLink(int currentLinkId)
 {
-    m_currentLink.setLinkId(currentLinkId);
+    d->currentLink.setLinkId(currentLinkId);
 }
 
 int Tab::nextLink() const
 {
-    return m_nextLinkId;
+    return d->nextLinkId;
 }
 
 void Tab::setNextLink(int nextLinkId)
 {
-    m_nextLinkId = nextLinkId;
+    d->nextLinkId = nextLinkId;
 }
 
 QString Tab::url() const
 {
-    return m_currentLink.url();
+    return d->currentLink.url();
+}
+
+InternedUrl Tab::internedUrl() const
+{
+    return d->currentLink.internedUrl();
 }
 
 void Tab::setUrl(const QString &url)
 {
-    m_currentLink.setUrl(url);
+    d->currentLink.setUrl(url);
 }
 
 QString Tab::thumbnailPath() const
 {
-    return m_currentLink.thumbPath();
+    return d->currentLink.thumbPath();
 }
 
 void Tab::setThumbnailPath(const QString &thumbnailPath)
 {
-    m_currentLink.setThumbPath(thumbnailPath);
+    d->currentLink.setThumbPath(thumbnailPath);
 }
 
 QString Tab::title() const
 {
-    return m_currentLink.title();
+    return d->currentLink.title();
 }
 
 void Tab::setTitle(const QString &title)
 {
-    m_currentLink.setTitle(title);
+    d->currentLink.setTitle(title);
 }
 
 bool Tab::isValid() const
 {
-    return m_tabId > 0;
+    return d->tabId > 0;
 }
 
 int Tab::previousLink() const
 {
-    return m_previousLinkId;
+    return d->previousLinkId;
 }
 
 void Tab::setPreviousLink(int previousLinkId)
 {
-    m_previousLinkId = previousLinkId;
+    d->previousLinkId = previousLinkId;
 }
 
 bool Tab::operator==(const Tab &other) const
 {
-    return (m_tabId == other.tabId() &&
-            m_previousLinkId == other.m_previousLinkId &&
-            m_nextLinkId == other.m_nextLinkId &&
-            m_currentLink == other.m_currentLink);
+    if (d == other.d) {
+        return true;
+    }
+
+    return (d->tabId == other.tabId() &&
+            d->previousLinkId == other.d->previousLinkId &&
+            d->nextLinkId == other.d->nextLinkId &&
+            d->currentLink == other.d->currentLink);
 }
 
 bool Tab::operator!=(const Tab &other) const
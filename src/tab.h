@@ -12,16 +12,30 @@
 #ifndef TAB_H
 #define TAB_H
 
+#include <QSharedDataPointer>
 #include <QString>
 #include <QDebug>
 
 #include "link.h"
 
+class TabData;
+
+// Implicitly shared, see Link.
 class Tab
 {
 public:
     explicit Tab(int tabId, Link currentLink, int nextLinkId, int previousLinkId);
     explicit Tab();
+    Tab(const Tab &other);
+    ~Tab();
+
+    Tab &operator=(const Tab &other);
+#ifdef Q_COMPILER_RVALUE_REFS
+    Tab(Tab &&other) : d(qMove(other.d)) {}
+    Tab &operator=(Tab &&other) { d.swap(other.d); return *this; }
+#endif
+
+    void swap(Tab &other) { d.swap(other.d); }
 
     int tabId() const;
     void setTabId(int tabId);
@@ -36,6 +50,7 @@ public:
     void setNextLink(int nextLinkId);
 
     QString url() const;
+    InternedUrl internedUrl() const;
     void setUrl(const QString &url);
 
     QString thumbnailPath() const;
@@ -50,12 +65,11 @@ public:
     bool operator!=(const Tab &other) const;
 
 private:
-    int m_tabId;
-    Link m_currentLink;
-    int m_nextLinkId;
-    int m_previousLinkId;
+    QSharedDataPointer<TabData> d;
 };
 
+Q_DECLARE_SHARED(Tab)
+
 QDebug operator<<(QDebug, const Tab *);
 
 #endif // TAB_H
@@ -0,0 +1,449 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "thumbnailcache.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMutexLocker>
+#include <QStandardPaths>
+
+#ifndef DEBUG_LOGS
+#define DEBUG_LOGS 0
+#endif
+
+static const int gDefaultMaxMemorySize = 8 * 1024 * 1024;
+static const qint64 gDefaultMaxDiskSize = 16 * 1024 * 1024;
+static const int gDefaultGridWidth = 540;
+static const int gDefaultCoverWidth = 234;
+// 75% quality jpg produces small and good enough capture.
+static const int gDefaultQuality = 75;
+static const char *gThumbnailPattern = "tab-*-thumb*.*";
+
+static const char *variantName(ThumbnailCache::Variant variant)
+{
+    switch (variant) {
+    case ThumbnailCache::GridVariant: return "grid";
+    case ThumbnailCache::CoverVariant: return "cover";
+    }
+    return "";
+}
+
+Q_GLOBAL_STATIC(ThumbnailCache, thumbnailCache)
+
+ThumbnailCache *ThumbnailCache::instance()
+{
+    return thumbnailCache();
+}
+
+ThumbnailCache::ThumbnailCache()
+    : m_directory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation))
+    , m_images(gDefaultMaxMemorySize)
+    , m_maxDiskSize(gDefaultMaxDiskSize)
+    , m_diskSize(-1)
+    , m_pipeline(ThumbnailPipeline::Jpeg, gDefaultQuality)
+{
+    m_variantWidths[GridVariant] = gDefaultGridWidth;
+    m_variantWidths[CoverVariant] = gDefaultCoverWidth;
+}
+
+/**
+ * Stores thumbnail \a image of the tab \a tabId. The perceptual \a signature of
+ * the image and the \a url of the page are kept for isCurrent() and the
+ * \a contentRect the page had when grabbed for contentRect(). Returns path of
+ * the grid variant, or an empty string if the thumbnail could not be written.
+ */
+QString ThumbnailCache::store(int tabId, const QImage &image, const QByteArray &signature,
+                              const QRectF &contentRect, const QString &url)
+{
+    if (image.isNull() || tabId <= 0) {
+        return QString();
+    }
+
+    // Scaling and encoding are done without holding the lock.
+    QString gridPath;
+    QString coverPath;
+    int width;
+    ThumbnailPipeline pipeline;
+    {
+        QMutexLocker locker(&m_mutex);
+        gridPath = path(tabId, GridVariant);
+        coverPath = path(tabId, CoverVariant);
+        width = m_variantWidths[GridVariant];
+        pipeline = m_pipeline;
+    }
+
+    qint64 oldSize = QFileInfo(gridPath).size() + QFileInfo(coverPath).size();
+    QImage grid = ThumbnailPipeline::downscale(image, width);
+    if (!pipeline.save(grid, gridPath)) {
+        qWarning() << "Cannot write thumbnail" << gridPath;
+        clearSignature(tabId);
+        return QString();
+    }
+    qint64 newSize = QFileInfo(gridPath).size();
+
+    bool trim = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        // Images of the previous thumbnail are stale.
+        removeImages(tabId, GridVariant);
+        removeImages(tabId, CoverVariant);
+        insertImage(key(tabId, GridVariant), grid);
+        QFile::remove(coverPath);
+        ++m_generations[tabId];
+        m_signatures.insert(tabId, signature);
+        m_signatureUrls.insert(tabId, url);
+        m_contentRects.insert(tabId, contentRect);
+        trim = addDiskSize(newSize - oldSize);
+    }
+
+    if (trim) {
+        trimDisk();
+    }
+    return gridPath;
+}
+
+/**
+ * Returns true if the stored thumbnail of the tab \a tabId is of the page \a url
+ * and looks the same as an image with the perceptual \a signature. Writing such
+ * an image can be skipped. Pages sharing a layout can have matching signatures,
+ * hence the url needs to match too.
+ */
+bool ThumbnailCache::isCurrent(int tabId, const QString &url, const QByteArray &signature) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_signatures.contains(tabId)
+            && m_signatureUrls.value(tabId) == url
+            && ThumbnailPipeline::signaturesMatch(m_signatures.value(tabId), signature)
+            && QFile::exists(path(tabId, GridVariant));
+}
+
+/**
+ * Forgets the signature of the tab \a tabId, so that the next thumbnail gets
+ * written even if it looks the same as the stored one. Used when the tab has
+ * lost its thumbnail, e.g. after a black grab.
+ */
+void ThumbnailCache::clearSignature(int tabId)
+{
+    QMutexLocker locker(&m_mutex);
+    m_signatures.remove(tabId);
+    m_signatureUrls.remove(tabId);
+}
+
+bool ThumbnailCache::contains(int tabId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return QFile::exists(path(tabId, GridVariant));
+}
+
+/**
+ * Returns the content rect of the page of the tab \a tabId when its thumbnail
+ * was grabbed, or an invalid rect if it is not known.
+ */
+QRectF ThumbnailCache::contentRect(int tabId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_contentRects.value(tabId);
+}
+
+/**
+ * Returns the \a variant thumbnail of the tab \a tabId, downscaled to the width
+ * of \a requestedSize, if given. Decoded and scaled images are kept in memory,
+ * so that delegates showing the thumbnail again at the same size reuse them.
+ */
+QImage ThumbnailCache::image(int tabId, Variant variant, const QSize &requestedSize)
+{
+    int requestedWidth = qMax(requestedSize.width(), 0);
+    QString imageKey = key(tabId, variant);
+    QString scaledKey = key(tabId, variant, requestedWidth);
+    QImage fullImage;
+    QString fileName;
+    int generation;
+    {
+        QMutexLocker locker(&m_mutex);
+        QImage *image = m_images.object(scaledKey);
+        if (image) {
+            return *image;
+        }
+        image = m_images.object(imageKey);
+        if (image) {
+            fullImage = *image;
+        }
+        fileName = path(tabId, variant);
+        generation = m_generations.value(tabId);
+    }
+
+    if (!fullImage.isNull()) {
+        if (requestedWidth == 0 || requestedWidth >= fullImage.width()) {
+            return fullImage;
+        }
+        QImage scaled = fullImage.scaledToWidth(requestedWidth, Qt::SmoothTransformation);
+        QMutexLocker locker(&m_mutex);
+        if (m_generations.value(tabId) == generation) {
+            insertImage(scaledKey, scaled);
+        }
+        return scaled;
+    }
+
+    QImageReader reader(fileName);
+    QSize size = reader.size();
+    if (requestedWidth > 0 && size.isValid() && requestedWidth < size.width()) {
+        reader.setScaledSize(QSize(requestedWidth, size.height() * requestedWidth / size.width()));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull() && variant == CoverVariant) {
+        return createCover(tabId, requestedSize);
+    } else if (image.isNull()) {
+#if DEBUG_LOGS
+        qDebug() << "no thumbnail:" << fileName << reader.errorString();
+#endif
+        return image;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_generations.value(tabId) == generation) {
+        insertImage(reader.scaledSize().isValid() ? scaledKey : imageKey, image);
+    }
+    return image;
+}
+
+void ThumbnailCache::remove(int tabId)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = GridVariant; i <= CoverVariant; ++i) {
+        QString fileName = path(tabId, (Variant)i);
+        removeImages(tabId, (Variant)i);
+        addDiskSize(-QFileInfo(fileName).size());
+        QFile::remove(fileName);
+    }
+    m_generations.remove(tabId);
+    m_signatures.remove(tabId);
+    m_signatureUrls.remove(tabId);
+    m_contentRects.remove(tabId);
+}
+
+void ThumbnailCache::clearMemory()
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.clear();
+}
+
+/**
+ * Returns image provider url of the \a variant thumbnail of the tab \a tabId.
+ * The url changes whenever the thumbnail is stored again.
+ */
+QString ThumbnailCache::source(int tabId, Variant variant) const
+{
+    QMutexLocker locker(&m_mutex);
+    return QString("image://thumbnail/%1/%2/%3").arg(tabId).arg(variantName(variant)).arg(m_generations.value(tabId));
+}
+
+QString ThumbnailCache::path(int tabId, Variant variant) const
+{
+    // Grid variant keeps the file name used before variants existed.
+    if (variant == GridVariant) {
+        return QString("%1/tab-%2-thumb.%3").arg(m_directory).arg(tabId).arg(m_pipeline.suffix());
+    }
+    return QString("%1/tab-%2-thumb-%3.%4").arg(m_directory).arg(tabId).arg(variantName(variant)).arg(m_pipeline.suffix());
+}
+
+void ThumbnailCache::setVariantWidth(Variant variant, int width)
+{
+    QMutexLocker locker(&m_mutex);
+    m_variantWidths[variant] = width;
+}
+
+int ThumbnailCache::variantWidth(Variant variant) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_variantWidths[variant];
+}
+
+void ThumbnailCache::setMaxMemorySize(int bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_images.setMaxCost(bytes);
+}
+
+int ThumbnailCache::memorySize() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_images.totalCost();
+}
+
+void ThumbnailCache::setMaxDiskSize(qint64 bytes)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_maxDiskSize = bytes;
+    }
+    trimDisk();
+}
+
+qint64 ThumbnailCache::diskSize() const
+{
+    QMutexLocker locker(&m_mutex);
+    qint64 size = 0;
+    QFileInfoList files = QDir(m_directory).entryInfoList(QStringList() << gThumbnailPattern, QDir::Files);
+    for (int i = 0; i < files.count(); ++i) {
+        size += files.at(i).size();
+    }
+    return size;
+}
+
+void ThumbnailCache::setDirectory(const QString &directory)
+{
+    QMutexLocker locker(&m_mutex);
+    m_directory = directory;
+    m_diskSize = -1;
+    m_images.clear();
+    m_signatures.clear();
+    m_signatureUrls.clear();
+    m_contentRects.clear();
+}
+
+/**
+ * Sets the image \a format and encoding \a quality of thumbnails stored after
+ * this call.
+ */
+void ThumbnailCache::setEncoding(ThumbnailPipeline::Format format, int quality)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pipeline.setFormat(format);
+    m_pipeline.setQuality(quality);
+}
+
+/**
+ * Returns the memory cache key of the \a variant image of the tab \a tabId,
+ * or of the image scaled to \a width, if given.
+ */
+QString ThumbnailCache::key(int tabId, Variant variant, int width)
+{
+    if (width > 0) {
+        return QString("%1/%2/%3").arg(tabId).arg(variantName(variant)).arg(width);
+    }
+    return QString("%1/%2").arg(tabId).arg(variantName(variant));
+}
+
+// Called with m_mutex held.
+void ThumbnailCache::removeImages(int tabId, Variant variant)
+{
+    QString imageKey = key(tabId, variant);
+    QString scaledPrefix = imageKey + QLatin1Char('/');
+    QList<QString> keys = m_images.keys();
+    for (int i = 0; i < keys.count(); ++i) {
+        if (keys.at(i) == imageKey || keys.at(i).startsWith(scaledPrefix)) {
+            m_images.remove(keys.at(i));
+        }
+    }
+}
+
+// Called with m_mutex held.
+void ThumbnailCache::insertImage(const QString &imageKey, const QImage &image)
+{
+    m_images.insert(imageKey, new QImage(image), image.byteCount());
+}
+
+/**
+ * Scales the cover variant of the tab \a tabId from its grid variant and writes
+ * it to disk. Returns an empty image if the tab has no thumbnail.
+ */
+QImage ThumbnailCache::createCover(int tabId, const QSize &requestedSize)
+{
+    int generation;
+    QString coverPath;
+    int width;
+    ThumbnailPipeline pipeline;
+    {
+        QMutexLocker locker(&m_mutex);
+        generation = m_generations.value(tabId);
+        coverPath = path(tabId, CoverVariant);
+        width = m_variantWidths[CoverVariant];
+        pipeline = m_pipeline;
+    }
+
+    QImage grid = image(tabId, GridVariant);
+    if (grid.isNull()) {
+        return grid;
+    }
+
+    QImage cover = ThumbnailPipeline::downscale(grid, width);
+    bool saved = pipeline.save(cover, coverPath);
+    bool trim = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_generations.value(tabId) != generation) {
+            // Stored again meanwhile, the cover was made of the old thumbnail.
+            QFile::remove(coverPath);
+        } else {
+            insertImage(key(tabId, CoverVariant), cover);
+            trim = saved && addDiskSize(QFileInfo(coverPath).size());
+        }
+    }
+
+    if (trim) {
+        trimDisk();
+    }
+
+    if (requestedSize.isValid() && requestedSize.width() < cover.width()) {
+        return cover.scaledToWidth(requestedSize.width(), Qt::SmoothTransformation);
+    }
+    return cover;
+}
+
+// Accounts \a bytes written to disk. Returns true if the disk needs trimming.
+// Called with the mutex held.
+bool ThumbnailCache::addDiskSize(qint64 bytes)
+{
+    if (m_diskSize >= 0) {
+        m_diskSize = qMax(Q_INT64_C(0), m_diskSize + bytes);
+    }
+    return m_diskSize < 0 || m_diskSize > m_maxDiskSize;
+}
+
+// Removes least recently written thumbnails until the disk cap is met and
+// recalculates the disk size. Lists the directory, so it is called without
+// holding the mutex and only when the disk size is over the cap or unknown.
+void ThumbnailCache::trimDisk()
+{
+    QString directory;
+    qint64 maxDiskSize;
+    {
+        QMutexLocker locker(&m_mutex);
+        directory = m_directory;
+        maxDiskSize = m_maxDiskSize;
+    }
+
+    QFileInfoList files = QDir(directory).entryInfoList(QStringList() << gThumbnailPattern,
+                                                        QDir::Files, QDir::Time);
+    qint64 size = 0;
+    qint64 keptSize = 0;
+    for (int i = 0; i < files.count(); ++i) {
+        size += files.at(i).size();
+        if (size > maxDiskSize) {
+#if DEBUG_LOGS
+            qDebug() << "removing thumbnail over the disk cap:" << files.at(i).fileName();
+#endif
+            QFile::remove(files.at(i).absoluteFilePath());
+        } else {
+            keptSize = size;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_directory == directory) {
+        m_diskSize = keptSize;
+    }
+}
@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QRectF>
+#include <QSize>
+#include <QString>
+
+#include "thumbnailpipeline.h"
+
+// Tab thumbnails in sized variants. Decoded variants are kept in a memory LRU
+// bounded by bytes, encoded variants on disk under a size cap. Only the grid
+// variant is written when a thumbnail is stored, the cover variant is created
+// from it when first requested. Thread safe, thumbnails are stored from the grab
+// writer thread and read from QML image loading threads.
+class ThumbnailCache
+{
+public:
+    enum Variant {
+        GridVariant,
+        CoverVariant
+    };
+
+    static ThumbnailCache *instance();
+
+    ThumbnailCache();
+
+    QString store(int tabId, const QImage &image, const QByteArray &signature = QByteArray(),
+                  const QRectF &contentRect = QRectF(), const QString &url = QString());
+    bool isCurrent(int tabId, const QString &url, const QByteArray &signature) const;
+    void clearSignature(int tabId);
+    bool contains(int tabId) const;
+    QRectF contentRect(int tabId) const;
+    QImage image(int tabId, Variant variant, const QSize &requestedSize = QSize());
+    void remove(int tabId);
+    void clearMemory();
+
+    QString source(int tabId, Variant variant) const;
+    QString path(int tabId, Variant variant) const;
+
+    void setVariantWidth(Variant variant, int width);
+    int variantWidth(Variant variant) const;
+
+    void setMaxMemorySize(int bytes);
+    int memorySize() const;
+
+    void setMaxDiskSize(qint64 bytes);
+    qint64 diskSize() const;
+
+    void setDirectory(const QString &directory);
+    void setEncoding(ThumbnailPipeline::Format format, int quality);
+
+private:
+    static QString key(int tabId, Variant variant, int width = 0);
+    void removeImages(int tabId, Variant variant);
+    void insertImage(const QString &imageKey, const QImage &image);
+    QImage createCover(int tabId, const QSize &requestedSize);
+    bool addDiskSize(qint64 bytes);
+    void trimDisk();
+
+    mutable QMutex m_mutex;
+    QString m_directory;
+    QCache<QString, QImage> m_images;
+    QHash<int, int> m_generations;
+    QHash<int, QByteArray> m_signatures;
+    // Url of the page each signature was taken of.
+    QHash<int, QString> m_signatureUrls;
+    QHash<int, QRectF> m_contentRects;
+    int m_variantWidths[CoverVariant + 1];
+    qint64 m_maxDiskSize;
+    // Size of thumbnails on disk as of the last trim plus what has been written
+    // since, or -1 if not known yet.
+    qint64 m_diskSize;
+    ThumbnailPipeline m_pipeline;
+};
+
+#endif // THUMBNAILCACHE_H
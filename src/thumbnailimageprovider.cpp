@@ -0,0 +1,40 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "thumbnailimageprovider.h"
+#include "thumbnailcache.h"
+
+#include <QStringList>
+
+ThumbnailImageProvider::ThumbnailImageProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+}
+
+QImage ThumbnailImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    QStringList parts = id.split('/');
+    bool ok = false;
+    int tabId = parts.value(0).toInt(&ok);
+    if (!ok) {
+        return QImage();
+    }
+
+    ThumbnailCache::Variant variant = parts.value(1) == QLatin1String("cover")
+            ? ThumbnailCache::CoverVariant : ThumbnailCache::GridVariant;
+    // QML passes 0 for a dimension that is not constrained.
+    QSize requested = requestedSize.width() > 0 ? QSize(requestedSize.width(), 0) : QSize();
+    QImage image = ThumbnailCache::instance()->image(tabId, variant, requested);
+    if (size) {
+        *size = image.size();
+    }
+    return image;
+}
@@ -0,0 +1,27 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef THUMBNAILIMAGEPROVIDER_H
+#define THUMBNAILIMAGEPROVIDER_H
+
+#include <QQuickImageProvider>
+
+// Serves tab thumbnails from ThumbnailCache. Image ids are of the form
+// <tabId>/<variant>/<generation>, see ThumbnailCache::source().
+class ThumbnailImageProvider : public QQuickImageProvider
+{
+public:
+    ThumbnailImageProvider();
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+};
+
+#endif // THUMBNAILIMAGEPROVIDER_H
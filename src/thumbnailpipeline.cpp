@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "thumbnailpipeline.h"
+
+#include <QBuffer>
+#include <QFile>
+#include <QImageWriter>
+#include <QVector>
+
+// Signature is the average luma of a grid of cells of this size per dimension.
+static const int gSignatureSize = 16;
+// Largest luma difference of a cell in matching signatures.
+static const int gSignatureTolerance = 6;
+
+// Per channel average of two 32-bit pixels, rounded down.
+static inline quint32 average(quint32 a, quint32 b)
+{
+    return (a & b) + (((a ^ b) & 0xfefefefe) >> 1);
+}
+
+// Halves both dimensions, each target pixel is the average of a 2x2 box.
+static QImage halve(const QImage &image)
+{
+    int w = image.width() / 2;
+    int h = image.height() / 2;
+    QImage result(w, h, image.format());
+    for (int y = 0; y < h; ++y) {
+        const quint32 *upper = reinterpret_cast<const quint32 *>(image.constScanLine(2 * y));
+        const quint32 *lower = reinterpret_cast<const quint32 *>(image.constScanLine(2 * y + 1));
+        quint32 *target = reinterpret_cast<quint32 *>(result.scanLine(y));
+        for (int x = 0; x < w; ++x) {
+            target[x] = average(average(upper[2 * x], upper[2 * x + 1]),
+                                average(lower[2 * x], lower[2 * x + 1]));
+        }
+    }
+    return result;
+}
+
+static bool isSupported(ThumbnailPipeline::Format format)
+{
+    // WebP writer is a plugin that may be missing.
+    static const bool webPSupported = QImageWriter::supportedImageFormats().contains("webp");
+    return format != ThumbnailPipeline::WebP || webPSupported;
+}
+
+ThumbnailPipeline::ThumbnailPipeline(Format format, int quality)
+    : m_format(format)
+    , m_quality(quality)
+{
+}
+
+ThumbnailPipeline::Format ThumbnailPipeline::format() const
+{
+    return m_format;
+}
+
+void ThumbnailPipeline::setFormat(Format format)
+{
+    m_format = format;
+}
+
+int ThumbnailPipeline::quality() const
+{
+    return m_quality;
+}
+
+void ThumbnailPipeline::setQuality(int quality)
+{
+    m_quality = quality;
+}
+
+QString ThumbnailPipeline::suffix() const
+{
+    switch (encodedFormat()) {
+    case WebP: return QStringLiteral("webp");
+    case Png: return QStringLiteral("png");
+    case Jpeg: break;
+    }
+    return QStringLiteral("jpg");
+}
+
+QString ThumbnailPipeline::mimeType() const
+{
+    switch (encodedFormat()) {
+    case WebP: return QStringLiteral("image/webp");
+    case Png: return QStringLiteral("image/png");
+    case Jpeg: break;
+    }
+    return QStringLiteral("image/jpeg");
+}
+
+QByteArray ThumbnailPipeline::encode(const QImage &image) const
+{
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QImageWriter writer(&buffer, suffix().toLatin1());
+    writer.setQuality(m_quality);
+    if (image.isNull() || !writer.write(image)) {
+        return QByteArray();
+    }
+    return data;
+}
+
+bool ThumbnailPipeline::save(const QImage &image, const QString &path) const
+{
+    QByteArray data = encode(image);
+    QFile file(path);
+    return !data.isEmpty() && file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+/**
+ * Returns the part of the \a image within \a bounds. The returned image refers to
+ * pixels of the \a image, which must outlive it.
+ */
+QImage ThumbnailPipeline::crop(const QImage &image, const QRect &bounds)
+{
+    QRect rect = bounds.intersected(image.rect());
+    if (rect.isEmpty()) {
+        return QImage();
+    }
+    return QImage(image.constScanLine(rect.y()) + rect.x() * image.depth() / 8,
+                  rect.width(), rect.height(), image.bytesPerLine(), image.format());
+}
+
+/**
+ * Downscales the \a image to \a width keeping the aspect ratio. Box filtered
+ * halving is used down to twice the target width, the rest is interpolated.
+ * Smaller images are returned as is.
+ */
+QImage ThumbnailPipeline::downscale(const QImage &image, int width)
+{
+    if (image.isNull() || width <= 0 || image.width() <= width) {
+        return image;
+    }
+
+    QImage scaled = image;
+    if (scaled.depth() != 32) {
+        scaled = scaled.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+    while (scaled.width() >= 2 * width && scaled.height() >= 2) {
+        scaled = halve(scaled);
+    }
+    if (scaled.width() != width) {
+        scaled = scaled.scaledToWidth(width, Qt::SmoothTransformation);
+    }
+    return scaled;
+}
+
+/**
+ * Crops the \a image to \a cropBounds and downscales it to \a width. The returned
+ * image owns its pixels.
+ */
+QImage ThumbnailPipeline::process(const QImage &image, const QRect &cropBounds, int width)
+{
+    QImage cropped = crop(image, cropBounds);
+    if (cropped.isNull()) {
+        return cropped;
+    }
+
+    QImage scaled = downscale(cropped, width);
+    // Detach from the pixels of the source image.
+    return scaled.constBits() == cropped.constBits() ? cropped.copy() : scaled;
+}
+
+/**
+ * Returns a perceptual signature of the \a image: average luma of each cell of a
+ * 16x16 grid. Signatures of images that look the same match, see signaturesMatch().
+ */
+QByteArray ThumbnailPipeline::signature(const QImage &image)
+{
+    if (image.isNull()) {
+        return QByteArray();
+    }
+
+    QImage source = image.depth() == 32 ? image : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    int w = source.width();
+    int h = source.height();
+    QVector<int> columns(w);
+    for (int x = 0; x < w; ++x) {
+        columns[x] = x * gSignatureSize / w;
+    }
+
+    QVector<quint32> sums(gSignatureSize * gSignatureSize, 0);
+    QVector<quint32> counts(gSignatureSize * gSignatureSize, 0);
+    for (int y = 0; y < h; ++y) {
+        int row = y * gSignatureSize / h * gSignatureSize;
+        const QRgb *line = reinterpret_cast<const QRgb *>(source.constScanLine(y));
+        for (int x = 0; x < w; ++x) {
+            QRgb pixel = line[x];
+            // Rec. 601 weights in fixed point.
+            sums[row + columns[x]] += (qRed(pixel) * 77 + qGreen(pixel) * 150 + qBlue(pixel) * 29) >> 8;
+            ++counts[row + columns[x]];
+        }
+    }
+
+    QByteArray signature(gSignatureSize * gSignatureSize, 0);
+    for (int i = 0; i < signature.size(); ++i) {
+        signature[i] = counts.at(i) ? char(sums.at(i) / counts.at(i)) : char(0);
+    }
+    return signature;
+}
+
+bool ThumbnailPipeline::signaturesMatch(const QByteArray &first, const QByteArray &second)
+{
+    if (first.isEmpty() || first.size() != second.size()) {
+        return false;
+    }
+
+    for (int i = 0; i < first.size(); ++i) {
+        if (qAbs(int(quint8(first.at(i))) - int(quint8(second.at(i)))) > gSignatureTolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ThumbnailPipeline::Format ThumbnailPipeline::encodedFormat() const
+{
+    return isSupported(m_format) ? m_format : Jpeg;
+}
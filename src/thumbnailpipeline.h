@@ -0,0 +1,59 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef THUMBNAILPIPELINE_H
+#define THUMBNAILPIPELINE_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QString>
+
+// Image work of page grabs: crop, downscale and encode. Functions are reentrant
+// and meant to be run on a QtConcurrent worker thread, never on the GUI thread.
+class ThumbnailPipeline
+{
+public:
+    enum Format {
+        Jpeg,
+        WebP,
+        Png
+    };
+
+    explicit ThumbnailPipeline(Format format = Jpeg, int quality = 75);
+
+    Format format() const;
+    void setFormat(Format format);
+
+    int quality() const;
+    void setQuality(int quality);
+
+    QString suffix() const;
+    QString mimeType() const;
+
+    QByteArray encode(const QImage &image) const;
+    bool save(const QImage &image, const QString &path) const;
+
+    static QImage crop(const QImage &image, const QRect &bounds);
+    static QImage downscale(const QImage &image, int width);
+    static QImage process(const QImage &image, const QRect &cropBounds, int width);
+
+    static QByteArray signature(const QImage &image);
+    static bool signaturesMatch(const QByteArray &first, const QByteArray &second);
+
+private:
+    Format encodedFormat() const;
+
+    Format m_format;
+    int m_quality;
+};
+
+#endif // THUMBNAILPIPELINE_H
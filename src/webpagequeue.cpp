@@ -11,9 +11,15 @@
 
 #include "webpagequeue.h"
 #include "declarativewebpage.h"
+#include "webpagetrace.h"
 
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
 #include <QObject>
 #include <QRectF>
+#include <QStandardPaths>
 
 #ifndef DEBUG_LOGS
 #define DEBUG_LOGS 0
@@ -23,15 +29,60 @@
 #include <QDebug>
 #endif
 
+// Page states of virtualized pages exceeding this are spilled to disk.
+static const int gMaxPageStateMemory = 1024 * 1024; // 1 MiB
+
+static QString pageStatePath(int tabId)
+{
+    return QString("%1/tab-%2-state.dat").arg(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).arg(tabId);
+}
+
+static QByteArray serializePageState(const QVariant &pageState)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << pageState;
+    return qCompress(data);
+}
+
+static QVariant deserializePageState(const QByteArray &data)
+{
+    QVariant pageState;
+    QDataStream in(qUncompress(data));
+    in >> pageState;
+    return pageState;
+}
+
+static bool writePageState(int tabId, const QByteArray &data)
+{
+    QDir().mkpath(QStandardPaths::writableLocation(QStandardPaths::CacheLocation));
+    QFile file(pageStatePath(tabId));
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+static QByteArray readPageState(int tabId)
+{
+    QByteArray data;
+    QFile file(pageStatePath(tabId));
+    if (file.open(QIODevice::ReadOnly)) {
+        data = file.readAll();
+        file.remove();
+    }
+    return data;
+}
+
 WebPageQueue::WebPageQueue()
     : m_maxLiveCount(5)
+    , m_pageStateSize(0)
     , m_livePagePrepended(false)
 {
 }
 
 WebPageQueue::~WebPageQueue()
 {
-    clear();
+    // Page states survive browser restarts.
+    savePageStates();
+    deleteEntries();
 }
 
 int WebPageQueue::count() const
@@ -48,6 +99,13 @@ bool WebPageQueue::alive(int tabId) const
     return index >= 0 && webPageEntry && webPageEntry->webPage;
 }
 
+bool WebPageQueue::virtualized(int tabId) const
+{
+    int index = -1;
+    WebPageQueue::WebPageEntry *webPageEntry = find(tabId, index);
+    return index >= 0 && webPageEntry && !webPageEntry->webPage;
+}
+
 bool WebPageQueue::active(int tabId) const
 {
     if (!m_queue.isEmpty()) {
@@ -65,10 +123,14 @@ DeclarativeWebPage *WebPageQueue::activate(int tabId)
     WebPageEntry *pageEntry = find(tabId, index);
     // No need to change position for the first index.
     if (index > 0) {
+        m_queue.at(0)->lastActive = QDateTime::currentMSecsSinceEpoch();
         m_queue.removeAt(index);
         m_queue.prepend(pageEntry);
     }
 
+    if (pageEntry) {
+        pageEntry->suspended = false;
+    }
     return pageEntry ? pageEntry->webPage : 0;
 }
 
@@ -77,6 +139,21 @@ DeclarativeWebPage *WebPageQueue::activeWebPage() const
     return !m_queue.isEmpty() ? m_queue.at(0)->webPage : 0;;
 }
 
+/**
+ * Suspends the view of the live page of \a tabId. Does nothing if the view
+ * has already been suspended after the page was last activated.
+ */
+void WebPageQueue::suspend(int tabId)
+{
+    int index = -1;
+    WebPageEntry *pageEntry = find(tabId, index);
+    if (pageEntry && pageEntry->webPage && !pageEntry->suspended) {
+        pageEntry->suspended = true;
+        WebPageTrace::instance()->record(WebPageTrace::Suspend, tabId);
+        pageEntry->webPage->suspendView();
+    }
+}
+
 void WebPageQueue::release(int tabId,  bool virtualize)
 {
     int index = -1;
@@ -88,23 +165,34 @@ void WebPageQueue::release(int tabId,  bool virtualize)
     if (pageEntry) {
         if (pageEntry->webPage) {
             if (virtualize) {
+                WebPageTrace::instance()->record(WebPageTrace::Virtualize, tabId);
                 pageEntry->cssContentRect = new QRectF(pageEntry->webPage->contentRect());
+                storePageState(pageEntry, pageEntry->webPage->pageState());
             }
             if (pageEntry->webPage->viewReady()) {
-                pageEntry->webPage->setParent(0);
-                delete pageEntry->webPage;
+                // Destroying a view is expensive. Let the owner of the queue
+                // decide when it is done.
+                pageEntry->webPage->setVisible(false);
+                m_releasedPages.append(pageEntry->webPage);
             } else {
                 QObject::connect(pageEntry->webPage, SIGNAL(viewReadyChanged()), pageEntry->webPage, SLOT(deleteLater()));
             }
         }
 
         pageEntry->webPage = 0;
+        pageEntry->pageStatePending = false;
+        pageEntry->suspended = false;
         if (!virtualize && index >= 0) {
+            m_pageStateSize -= pageEntry->pageState.size();
             delete pageEntry;
             m_queue.removeAt(index);
         }
     }
 
+    if (!virtualize) {
+        QFile::remove(pageStatePath(tabId));
+    }
+
 #if DEBUG_LOGS
     qDebug() << "--- end ---";
     dumpPages();
@@ -113,56 +201,125 @@ void WebPageQueue::release(int tabId,  bool virtualize)
 
 
 void WebPageQueue::prepend(int tabId, DeclarativeWebPage *webPage)
+{
+    WebPageEntry *pageEntry = takeEntry(tabId, webPage);
+    if (!m_queue.isEmpty()) {
+        m_queue.at(0)->lastActive = QDateTime::currentMSecsSinceEpoch();
+    }
+    m_queue.prepend(pageEntry);
+    updateLivePages();
+    m_livePagePrepended = true;
+}
+
+/**
+ * Adds an inactive live page after the other live pages. Used for pages that are
+ * loaded in background.
+ */
+void WebPageQueue::append(int tabId, DeclarativeWebPage *webPage)
+{
+    if (alive(tabId)) {
+        return;
+    }
+
+    WebPageEntry *pageEntry = takeEntry(tabId, webPage);
+    m_queue.insert(count(), pageEntry);
+    updateLivePages();
+}
+
+/**
+ * Returns the entry for \a webPage of the tab \a tabId, taking it out of the
+ * queue. A virtualized entry of the tab gets resurrected with its page state,
+ * otherwise a new entry restores the state saved by the previous session.
+ */
+WebPageQueue::WebPageEntry *WebPageQueue::takeEntry(int tabId, DeclarativeWebPage *webPage)
 {
     int index = -1;
-    WebPageQueue::WebPageEntry *pageEntry = find(tabId, index);
+    WebPageEntry *pageEntry = find(tabId, index);
     if (!pageEntry) {
         pageEntry = new WebPageEntry(webPage, 0);
-    } else {
-        pageEntry->webPage = webPage;
-        pageEntry->tabId = tabId;
-        pageEntry->webPage->setResurrectedContentRect(*pageEntry->cssContentRect);
-        if (pageEntry->cssContentRect) {
-            delete pageEntry->cssContentRect;
-            pageEntry->cssContentRect = 0;
+        // State saved by the previous browser session.
+        QByteArray data = readPageState(tabId);
+        if (!data.isEmpty()) {
+            webPage->setPageState(deserializePageState(data));
         }
-        m_queue.removeAt(index);
+        return pageEntry;
     }
 
-    m_queue.prepend(pageEntry);
-    updateLivePages();
-    m_livePagePrepended = true;
+    WebPageTrace::instance()->record(WebPageTrace::Resurrect, tabId);
+    pageEntry->webPage = webPage;
+    pageEntry->tabId = tabId;
+    pageEntry->webPage->setPageState(takePageState(pageEntry));
+    if (pageEntry->cssContentRect) {
+        pageEntry->webPage->setResurrectedContentRect(*pageEntry->cssContentRect);
+        delete pageEntry->cssContentRect;
+        pageEntry->cssContentRect = 0;
+    }
+    m_queue.removeAt(index);
+    return pageEntry;
 }
 
 void WebPageQueue::clear()
 {
-    int count = m_queue.count();
-    for (int i = 0; i < count; ++i) {
-        WebPageEntry *pageEntry = m_queue.at(i);
-        pageEntry->allowPageDelete = true;
-        delete pageEntry;
+    for (int i = 0; i < m_queue.count(); ++i) {
+        QFile::remove(pageStatePath(m_queue.at(i)->tabId));
     }
-    m_queue.clear();
+    deleteEntries();
 }
 
-int WebPageQueue::parentTabId(int tabId) const
-{
-    // TODO: This should be stored to the declarativewebpage to avoid loops.
-    // This guarantees that child-parent relationship exists and it should
-    // be taken into account if/when moved to declarativewebpage.
-    // Ported from webpages.cpp.
-    int index = 0;
-    WebPageEntry *childPageEntry = find(tabId, index);
-    if (childPageEntry && childPageEntry->webPage) {
-        int parentId = childPageEntry->webPage->parentId();
-        for (int i = 0; i < m_queue.count(); ++i) {
-            WebPageEntry *parentPageEntry = m_queue.at(i);
-            if (parentPageEntry->webPage && (int)parentPageEntry->webPage->uniqueID() == parentId) {
-                return parentPageEntry->webPage->tabId();
+/**
+ * Writes page states of all pages to disk so that they can be restored
+ * after a browser restart.
+ */
+void WebPageQueue::savePageStates()
+{
+    for (int i = 0; i < m_queue.count(); ++i) {
+        WebPageEntry *pageEntry = m_queue.at(i);
+        if (pageEntry->webPage) {
+            QVariant pageState = pageEntry->webPage->pageState();
+            if (pageState.isValid()) {
+                writePageState(pageEntry->tabId, serializePageState(pageState));
             }
+        } else if (!pageEntry->pageState.isEmpty()) {
+            writePageState(pageEntry->tabId, pageEntry->pageState);
         }
     }
-    return 0;
+}
+
+/**
+ * Requests a fresh page state of the live page of \a tabId. The page is kept
+ * live until pageStateReceived() or expirePageStateRequests() is called, so
+ * that it does not get virtualized with a stale state.
+ */
+void WebPageQueue::requestPageState(int tabId)
+{
+    int index = -1;
+    WebPageEntry *pageEntry = find(tabId, index);
+    if (pageEntry && pageEntry->webPage) {
+        pageEntry->pageStatePending = true;
+        pageEntry->webPage->requestPageState();
+    }
+}
+
+void WebPageQueue::pageStateReceived(int tabId)
+{
+    int index = -1;
+    WebPageEntry *pageEntry = find(tabId, index);
+    if (pageEntry && pageEntry->pageStatePending) {
+        pageEntry->pageStatePending = false;
+        updateLivePages();
+    }
+}
+
+/**
+ * Gives up waiting for requested page states. Pages get virtualized with the
+ * state they have.
+ */
+void WebPageQueue::expirePageStateRequests()
+{
+    for (int i = 0; i < m_queue.count(); ++i) {
+        m_queue.at(i)->pageStatePending = false;
+    }
+    updateLivePages();
 }
 
 bool WebPageQueue::setMaxLivePages(int count)
@@ -180,26 +337,89 @@ int WebPageQueue::maxLivePages() const
     return m_maxLiveCount;
 }
 
-void WebPageQueue::virtualizeInactive()
+/**
+ * Virtualizes all inactive live pages except the ones listed in \a keepAlive.
+ */
+void WebPageQueue::virtualizeInactive(const QSet<int> &keepAlive)
 {
     if (!m_livePagePrepended || m_queue.isEmpty() || !m_queue.at(0)->webPage) {
         // no need to iterate through a queue of only one or zero live pages
         return;
     }
 
-    DeclarativeWebPage* livePage = m_queue.at(0)->webPage;
-
     for (int i = 1; i < m_queue.count(); ++i) {
-        DeclarativeWebPage* page = m_queue.at(i)->webPage;
-        if (page &&
-                (livePage->parentId() != (int)page->uniqueID() || (int)livePage->uniqueID() != page->parentId())) {
-            release(m_queue.at(i)->tabId, true);
+        WebPageEntry *pageEntry = m_queue.at(i);
+        if (pageEntry->webPage && !keepAlive.contains(pageEntry->tabId)) {
+            release(pageEntry->tabId, true);
         }
     }
 
     m_livePagePrepended = false;
 }
 
+/**
+ * Virtualizes the least recently used inactive live page that is not listed in
+ * \a keepAlive. Returns false if there was no such page.
+ */
+bool WebPageQueue::virtualizeLeastRecentlyUsed(const QSet<int> &keepAlive)
+{
+    if (m_queue.isEmpty() || !m_queue.at(0)->webPage) {
+        return false;
+    }
+
+    for (int i = m_queue.count() - 1; i > 0; --i) {
+        WebPageEntry *pageEntry = m_queue.at(i);
+        if (pageEntry->webPage && !keepAlive.contains(pageEntry->tabId)) {
+            release(pageEntry->tabId, true);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * Moves inactive pages towards cheaper states based on the time they have been
+ * inactive: live pages are suspended after \a suspendAge and virtualized after
+ * \a virtualizeAge milliseconds. Page state of a virtualized page is moved to
+ * disk after \a discardAge milliseconds. Pages listed in \a keepAlive are
+ * neither suspended nor virtualized.
+ */
+void WebPageQueue::sweepIdlePages(qint64 suspendAge, qint64 virtualizeAge, qint64 discardAge, const QSet<int> &keepAlive)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (int i = 1; i < m_queue.count(); ++i) {
+        WebPageEntry *pageEntry = m_queue.at(i);
+        qint64 idleTime = now - pageEntry->lastActive;
+        if (pageEntry->webPage) {
+            if (keepAlive.contains(pageEntry->tabId)) {
+                continue;
+            } else if (idleTime >= virtualizeAge && !pageEntry->pageStatePending) {
+                release(pageEntry->tabId, true);
+            } else if (idleTime >= suspendAge) {
+                suspend(pageEntry->tabId);
+            }
+        } else if (idleTime >= discardAge) {
+            discardPageState(pageEntry);
+        }
+    }
+}
+
+/**
+ * Returns true if there are inactive live pages, or virtualized pages whose
+ * state is still kept in memory, that sweepIdlePages() may need to handle.
+ */
+bool WebPageQueue::hasIdlePages() const
+{
+    for (int i = 1; i < m_queue.count(); ++i) {
+        WebPageEntry *pageEntry = m_queue.at(i);
+        if (pageEntry->webPage || !pageEntry->pageState.isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void WebPageQueue::dumpPages() const
 {
     qDebug() << "---- start ----";
@@ -208,6 +428,7 @@ void WebPageQueue::dumpPages() const
         qDebug() << "tabId: " << pageEntry->tabId;
         qDebug() << "    page: " << pageEntry->webPage;
         qDebug() << "    cssContentRect:" << pageEntry->cssContentRect;
+        qDebug() << "    lastActive:" << QDateTime::fromMSecsSinceEpoch(pageEntry->lastActive);
     }
     qDebug() << "---- end ------";
 }
@@ -216,7 +437,9 @@ void WebPageQueue::updateLivePages()
 {
     if (m_queue.count() > m_maxLiveCount && m_maxLiveCount > 1) {
         for (int i = m_maxLiveCount; i < m_queue.count(); ++i) {
-            release(m_queue.at(i)->tabId, true);
+            if (!m_queue.at(i)->pageStatePending) {
+                release(m_queue.at(i)->tabId, true);
+            }
         }
     }
 }
@@ -234,10 +457,72 @@ WebPageQueue::WebPageEntry *WebPageQueue::find(int tabId, int &index) const
     return 0;
 }
 
+void WebPageQueue::storePageState(WebPageEntry *pageEntry, const QVariant &pageState)
+{
+    if (!pageState.isValid()) {
+        return;
+    }
+
+    pageEntry->pageState = serializePageState(pageState);
+    m_pageStateSize += pageEntry->pageState.size();
+
+    // Spill least recently used states to disk.
+    for (int i = m_queue.count() - 1; i >= 0 && m_pageStateSize > gMaxPageStateMemory; --i) {
+        discardPageState(m_queue.at(i));
+    }
+}
+
+QVariant WebPageQueue::takePageState(WebPageEntry *pageEntry)
+{
+    QByteArray data;
+    if (!pageEntry->pageState.isEmpty()) {
+        data = pageEntry->pageState;
+        m_pageStateSize -= data.size();
+        pageEntry->pageState.clear();
+    } else {
+        data = readPageState(pageEntry->tabId);
+    }
+
+    return data.isEmpty() ? QVariant() : deserializePageState(data);
+}
+
+QList<DeclarativeWebPage *> WebPageQueue::takeReleasedPages()
+{
+    QList<DeclarativeWebPage *> releasedPages = m_releasedPages;
+    m_releasedPages.clear();
+    return releasedPages;
+}
+
+void WebPageQueue::discardPageState(WebPageEntry *pageEntry)
+{
+    if (!pageEntry->pageState.isEmpty() && writePageState(pageEntry->tabId, pageEntry->pageState)) {
+        m_pageStateSize -= pageEntry->pageState.size();
+        pageEntry->pageState.clear();
+    }
+}
+
+void WebPageQueue::deleteEntries()
+{
+    int count = m_queue.count();
+    for (int i = 0; i < count; ++i) {
+        WebPageEntry *pageEntry = m_queue.at(i);
+        pageEntry->allowPageDelete = true;
+        delete pageEntry;
+    }
+    m_queue.clear();
+    m_pageStateSize = 0;
+
+    qDeleteAll(m_releasedPages);
+    m_releasedPages.clear();
+}
+
 WebPageQueue::WebPageEntry::WebPageEntry(DeclarativeWebPage *webPage, QRectF *cssContentRect)
     : webPage(webPage)
     , tabId(webPage ? webPage->tabId() : 0)
     , cssContentRect(cssContentRect)
+    , lastActive(QDateTime::currentMSecsSinceEpoch())
+    , pageStatePending(false)
+    , suspended(false)
     , allowPageDelete(false)
 {
 }
@@ -13,6 +13,7 @@
 #define WEBPAGEQUEUE_H
 
 #include <QQueue>
+#include <QSet>
 
 class QRectF;
 class DeclarativeWebPage;
@@ -25,17 +26,27 @@ public :
 
     int count() const;
     bool alive(int tabId) const;
+    bool virtualized(int tabId) const;
     bool active(int tabId) const;
     DeclarativeWebPage *activate(int tabId);
     DeclarativeWebPage *activeWebPage() const;
+    void suspend(int tabId);
     void release(int tabId, bool virtualize = false);
     void prepend(int tabId, DeclarativeWebPage *webPage);
+    void append(int tabId, DeclarativeWebPage *webPage);
     void clear();
-    int parentTabId(int tabId) const;
+    void savePageStates();
+    void requestPageState(int tabId);
+    void pageStateReceived(int tabId);
+    void expirePageStateRequests();
+    QList<DeclarativeWebPage *> takeReleasedPages();
 
     bool setMaxLivePages(int count);
     int maxLivePages() const;
-    void virtualizeInactive();
+    void virtualizeInactive(const QSet<int> &keepAlive);
+    bool virtualizeLeastRecentlyUsed(const QSet<int> &keepAlive);
+    void sweepIdlePages(qint64 suspendAge, qint64 virtualizeAge, qint64 discardAge, const QSet<int> &keepAlive);
+    bool hasIdlePages() const;
 
     void dumpPages() const;
 
@@ -47,14 +58,32 @@ private:
         DeclarativeWebPage *webPage;
         int tabId;
         QRectF *cssContentRect;
+        // Compressed page state of a virtualized page. Empty when the page is
+        // live, has no state or the state has been spilled to disk.
+        QByteArray pageState;
+        // Time when the page was last the active page.
+        qint64 lastActive;
+        // Page state has been requested from the engine. The page is not
+        // virtualized before the reply arrives unless memory is short.
+        bool pageStatePending;
+        // View of the inactive live page has been suspended.
+        bool suspended;
         bool allowPageDelete;
     };
 
     void updateLivePages();
     WebPageEntry *find(int tabId, int &index) const;
+    WebPageEntry *takeEntry(int tabId, DeclarativeWebPage *webPage);
+    void storePageState(WebPageEntry *pageEntry, const QVariant &pageState);
+    QVariant takePageState(WebPageEntry *pageEntry);
+    void discardPageState(WebPageEntry *pageEntry);
+    void deleteEntries();
 
     QList<WebPageEntry *> m_queue;
+    // Released pages waiting to be destroyed by the owner of the queue.
+    QList<DeclarativeWebPage *> m_releasedPages;
     int m_maxLiveCount;
+    int m_pageStateSize;
 
     // This flag is set when we prepend a live page to the queue and reset upon
     // virtualization of inactive live pages as only one live page stays in the
@@ -12,33 +12,114 @@
 #include "webpages.h"
 #include "declarativewebcontainer.h"
 #include "declarativewebpage.h"
+#include "dbmanager.h"
+#include "iconstore.h"
+#include "thumbnailcache.h"
+#include "webpagetrace.h"
 #include "qmozcontext.h"
 
 #include <QDateTime>
 #include <QDBusConnection>
+#include <QDebug>
+#include <QFile>
+#include <QPixmapCache>
 #include <QQmlComponent>
 #include <QQmlEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
 #include <QMapIterator>
 #include <QRectF>
 #include <qqmlinfo.h>
 
+#include <unistd.h>
+
 #ifndef DEBUG_LOGS
 #define DEBUG_LOGS 0
 #endif
 
-#if DEBUG_LOGS
-#include <QDebug>
-#endif
-
-static const qint64 gMemoryPressureTimeout = 600 * 1000; // 600 sec
+// heap-minimize is expensive for the engine, don't send it more often than this.
+static const qint64 gHeapMinimizeInterval = 60 * 1000; // 60 sec
+// Interval between memory pressure stages while memory level stays high.
+static const int gWarningStageInterval = 1000; // 1 sec
+static const int gCriticalStageInterval = 100; // 100 ms
+// Delay before preloading the next tab of the previous session.
+static const int gPreloadDelay = 1000; // 1 sec
+// Idle tiers of inactive pages, checked once per sweep interval.
+static const int gIdleSweepInterval = 60 * 1000; // 1 min
+static const qint64 gIdleSuspendAge = 5 * 60 * 1000; // 5 min
+static const qint64 gIdleVirtualizeAge = 30 * 60 * 1000; // 30 min
+static const qint64 gIdleDiscardAge = 2 * 60 * 60 * 1000; // 2 hours
+// Roughly one frame between destroying released pages.
+static const int gTeardownInterval = 16; // 16 ms
+// Frames to wait for the active page to paint before destroying pages anyway.
+static const int gMaxTeardownDeferrals = 60;
+// SQLite cache sizes in kibibytes.
+static const int gDefaultDatabaseCacheSize = 2000;
+static const int gLowMemoryDatabaseCacheSize = 256;
+// Time to wait for the page state of a deactivated page before it may get virtualized.
+static const int gPageStateTimeout = 1000; // 1 sec
+// Spare pages are created only after the active page has had time to settle.
+static const int gSparePageDelay = 2000; // 2 sec
 // In normal cases gLowMemoryEnabled is true. Can be disabled e.g. for test runs.
 static const bool gLowMemoryEnabled = qgetenv("LOW_MEMORY_DISABLED").isEmpty();
 
+// Returns resident set size of the process in bytes.
+static qint64 residentMemory()
+{
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    QList<QByteArray> fields = statm.readAll().split(' ');
+    return fields.count() > 1 ? fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE) : 0;
+}
+
 WebPages::WebPages(QObject *parent)
     : QObject(parent)
-    , m_backgroundTimestamp(0)
+    , m_maxSparePages(1)
+    , m_maxPreloadPages(0)
+    , m_idleSuspendAge(gIdleSuspendAge)
+    , m_idleVirtualizeAge(gIdleVirtualizeAge)
+    , m_idleDiscardAge(gIdleDiscardAge)
+    , m_teardownDeferrals(0)
+    , m_memoryPressureStage(0)
+    , m_memoryLevel(NormalMemory)
+    , m_databaseCacheShrunk(false)
+    , m_heapMinimizeTimestamp(0)
 {
+    m_spareTimer.setSingleShot(true);
+    m_spareTimer.setInterval(gSparePageDelay);
+    connect(&m_spareTimer, SIGNAL(timeout()), this, SLOT(fillSparePages()));
+
+    m_preloadTimer.setSingleShot(true);
+    m_preloadTimer.setInterval(gPreloadDelay);
+    connect(&m_preloadTimer, SIGNAL(timeout()), this, SLOT(preloadNext()));
+
+    // One coalesced timer for all pages to keep wakeups low. Runs only while
+    // there are inactive pages to sweep.
+    m_idleSweepTimer.setInterval(gIdleSweepInterval);
+    connect(&m_idleSweepTimer, SIGNAL(timeout()), this, SLOT(sweepIdlePages()));
+
+    m_teardownTimer.setSingleShot(true);
+    m_teardownTimer.setInterval(gTeardownInterval);
+    connect(&m_teardownTimer, SIGNAL(timeout()), this, SLOT(teardownReleasedPage()));
+
+    m_pageStateTimer.setSingleShot(true);
+    m_pageStateTimer.setInterval(gPageStateTimeout);
+    connect(&m_pageStateTimer, SIGNAL(timeout()), this, SLOT(expirePageStateRequests()));
+
+    m_memoryPressureTimer.setSingleShot(true);
+    connect(&m_memoryPressureTimer, SIGNAL(timeout()), this, SLOT(runMemoryPressureStage()));
+
+    // Cheapest stages first. Virtualizing pages loses state of the pages and
+    // hence all inactive pages are virtualized only on critical level.
+    addMemoryPressureStage("image caches", WarningMemory, this, "releaseImageCaches");
+    addMemoryPressureStage("database cache", WarningMemory, this, "shrinkDatabaseCache");
+    addMemoryPressureStage("heap minimize", WarningMemory, this, "minimizeHeap");
+    addMemoryPressureStage("virtualize least recently used", WarningMemory, this, "virtualizeLeastRecentlyUsed");
+    addMemoryPressureStage("virtualize inactive", CriticalMemory, this, "virtualizeInactive");
+
     if (gLowMemoryEnabled) {
         QDBusConnection::systemBus().connect("com.nokia.mce", "/com/nokia/mce/signal",
                                              "com.nokia.mce.signal", "sig_memory_level_ind",
@@ -48,6 +129,8 @@ WebPages::WebPages(QObject *parent)
 
 WebPages::~WebPages()
 {
+    releaseSparePages();
+    flushTeardown();
 }
 
 void WebPages::initialize(DeclarativeWebContainer *webContainer, QQmlComponent *webPageComponent)
@@ -57,13 +140,21 @@ void WebPages::initialize(DeclarativeWebContainer *webContainer, QQmlComponent *
         m_webPageComponent = webPageComponent;
     }
 
-    connect(webContainer, SIGNAL(foregroundChanged()), this, SLOT(updateBackgroundTimestamp()));
+    connect(webContainer, SIGNAL(foregroundChanged()), this, SLOT(handleForegroundChanged()), Qt::UniqueConnection);
+    updateIdleSweep();
 }
 
-void WebPages::updateBackgroundTimestamp()
+void WebPages::handleForegroundChanged()
 {
-    if (!m_webContainer->foreground()) {
-        m_backgroundTimestamp = QDateTime::currentMSecsSinceEpoch();
+    if (m_webContainer->foreground()) {
+        scheduleSparePages();
+    } else {
+        // Browser may get killed while in background. Store what is known now
+        // and refresh the state of the active page for the next round.
+        m_activePages.savePageStates();
+        if (m_activePages.activeWebPage()) {
+            m_activePages.activeWebPage()->requestPageState();
+        }
     }
 }
 
@@ -79,7 +170,9 @@ int WebPages::count() const
 
 bool WebPages::setMaxLivePages(int count)
 {
-    return m_activePages.setMaxLivePages(count);
+    bool changed = m_activePages.setMaxLivePages(count);
+    scheduleTeardown();
+    return changed;
 }
 
 int WebPages::maxLivePages() const
@@ -87,6 +180,58 @@ int WebPages::maxLivePages() const
     return m_activePages.maxLivePages();
 }
 
+/**
+ * Sets the number of pre-created spare pages kept around for new tabs.
+ * Zero disables the spare page pool.
+ */
+bool WebPages::setMaxSparePages(int count)
+{
+    if (count < 0 || m_maxSparePages == count) {
+        return false;
+    }
+
+    m_maxSparePages = count;
+    releaseSparePages(m_maxSparePages);
+    scheduleSparePages();
+    return true;
+}
+
+int WebPages::maxSparePages() const
+{
+    return m_maxSparePages;
+}
+
+/**
+ * Sets the number of tabs preloaded by preload(). Zero disables preloading.
+ */
+bool WebPages::setMaxPreloadPages(int count)
+{
+    if (m_maxPreloadPages != count) {
+        m_maxPreloadPages = count;
+        if (m_maxPreloadPages == 0) {
+            m_preloadTimer.stop();
+            m_preloadQueue.clear();
+        }
+        return true;
+    }
+    return false;
+}
+
+int WebPages::maxPreloadPages() const
+{
+    return m_maxPreloadPages;
+}
+
+/**
+ * Loads given \a tabs in background, in the given order. At most maxPreloadPages()
+ * tabs are loaded, and never more than there is room for live pages.
+ */
+void WebPages::preload(const QList<Tab> &tabs)
+{
+    m_preloadQueue = tabs.mid(0, m_maxPreloadPages);
+    schedulePreload();
+}
+
 bool WebPages::alive(int tabId) const
 {
     return m_activePages.alive(tabId);
@@ -110,60 +255,343 @@ WebPageActivationData WebPages::page(int tabId, int parentId)
     qDebug() << "about to create a new tab or activate old:" << tabId;
 #endif
 
-    DeclarativeWebPage *webPage = 0;
+    WebPageTrace::Transition transition = WebPageTrace::LiveTransition;
     DeclarativeWebPage *oldActiveWebPage = m_activePages.activeWebPage();
+    if (oldActiveWebPage) {
+        // Refresh state of the page. The page is not virtualized before the
+        // state has arrived, or the request has timed out.
+        m_activePages.requestPageState(oldActiveWebPage->tabId());
+        connect(oldActiveWebPage, SIGNAL(pageStateChanged()), this, SLOT(onPageStateChanged()), Qt::UniqueConnection);
+        m_pageStateTimer.start();
+    }
+
     if (!m_activePages.alive(tabId)) {
-        QQmlContext *creationContext = m_webPageComponent->creationContext();
-        QQmlContext *context = new QQmlContext(creationContext ? creationContext : QQmlEngine::contextForObject(m_webContainer));
-        QObject *object = m_webPageComponent->beginCreate(context);
-        if (object) {
-            context->setParent(object);
-            object->setParent(m_webContainer);
-            webPage = qobject_cast<DeclarativeWebPage *>(object);
-            if (webPage) {
-                webPage->setParentItem(m_webContainer);
-                webPage->setParentID(parentId);
-                webPage->setTabId(tabId);
-                webPage->setContainer(m_webContainer);
-                m_webPageComponent->completeCreate();
+        // Spare pages are created without a parent. Pages opened by
+        // another page need to know their parent already during creation.
+        DeclarativeWebPage *webPage = parentId == 0 ? takeSparePage(tabId) : 0;
+        if (m_activePages.virtualized(tabId)) {
+            transition = WebPageTrace::ResurrectTransition;
+        } else {
+            transition = webPage ? WebPageTrace::SpareTransition : WebPageTrace::NewTransition;
+        }
+
+        if (!webPage) {
+            webPage = createPage(tabId, parentId);
+        }
+
+        if (webPage) {
 #if DEBUG_LOGS
-                qDebug() << "New view id:" << webPage->uniqueID() << "parentId:" << webPage->parentId() << "tab id:" << webPage->tabId();
+            qDebug() << "New view id:" << webPage->uniqueID() << "parentId:" << webPage->parentId() << "tab id:" << webPage->tabId();
 #endif
-                m_activePages.prepend(tabId, webPage);
-                QQmlEngine::setObjectOwnership(webPage, QQmlEngine::CppOwnership);
-            } else {
-                qmlInfo(m_webContainer) << "webPage component must be a WebPage component";
-            }
-        } else {
-            qmlInfo(m_webContainer) << "Creation of the web page failed. Error: " << m_webPageComponent->errorString();
-            delete object;
-            object = 0;
+            addToOpenerGraph(tabId, webPage);
+            m_activePages.prepend(tabId, webPage);
         }
     }
 
     DeclarativeWebPage *newActiveWebPage = m_activePages.activate(tabId);
     updateStates(oldActiveWebPage, newActiveWebPage);
+    if (newActiveWebPage) {
+        WebPageTrace::instance()->activated(tabId, transition);
+        tracePaint(newActiveWebPage);
+    }
 
 #if DEBUG_LOGS
     dumpPages();
 #endif
 
+    scheduleSparePages();
+    scheduleTeardown();
+    updateIdleSweep();
     return WebPageActivationData(newActiveWebPage, true);
 }
 
 void WebPages::release(int tabId, bool virtualize)
 {
     m_activePages.release(tabId, virtualize);
+    if (!virtualize) {
+        removeFromOpenerGraph(tabId);
+    }
+    scheduleTeardown();
+    updateIdleSweep();
 }
 
 void WebPages::clear()
 {
+    m_pageStateTimer.stop();
+    m_preloadTimer.stop();
+    m_preloadQueue.clear();
     m_activePages.clear();
+    m_tabIdToViewId.clear();
+    m_viewIdToTabId.clear();
+    m_openers.clear();
+    m_children.clear();
+    releaseSparePages();
+    flushTeardown();
+    updateIdleSweep();
 }
 
+/**
+ * Returns tab id of the tab that opened \a tabId, or 0 if the tab was not
+ * opened by another tab.
+ */
 int WebPages::parentTabId(int tabId) const
 {
-    return m_activePages.parentTabId(tabId);
+    return m_openers.value(tabId);
+}
+
+QList<int> WebPages::childTabIds(int tabId) const
+{
+    return m_children.values(tabId);
+}
+
+DeclarativeWebPage *WebPages::createPage(int tabId, int parentId)
+{
+    DeclarativeWebPage *webPage = 0;
+    QQmlContext *creationContext = m_webPageComponent->creationContext();
+    QQmlContext *context = new QQmlContext(creationContext ? creationContext : QQmlEngine::contextForObject(m_webContainer));
+    QObject *object = m_webPageComponent->beginCreate(context);
+    if (object) {
+        context->setParent(object);
+        object->setParent(m_webContainer);
+        webPage = qobject_cast<DeclarativeWebPage *>(object);
+        if (webPage) {
+            webPage->setParentItem(m_webContainer);
+            webPage->setParentID(parentId);
+            webPage->setTabId(tabId);
+            webPage->setContainer(m_webContainer);
+            m_webPageComponent->completeCreate();
+            QQmlEngine::setObjectOwnership(webPage, QQmlEngine::CppOwnership);
+        } else {
+            qmlInfo(m_webContainer) << "webPage component must be a WebPage component";
+        }
+    } else {
+        qmlInfo(m_webContainer) << "Creation of the web page failed. Error: " << m_webPageComponent->errorString();
+        delete object;
+        object = 0;
+    }
+    return webPage;
+}
+
+DeclarativeWebPage *WebPages::takeSparePage(int tabId)
+{
+    if (m_sparePages.isEmpty()) {
+        return 0;
+    }
+
+    // Prefer a spare page whose view is already initialized.
+    int index = 0;
+    for (int i = 0; i < m_sparePages.count(); ++i) {
+        if (m_sparePages.at(i)->viewReady()) {
+            index = i;
+            break;
+        }
+    }
+
+    DeclarativeWebPage *webPage = m_sparePages.takeAt(index);
+    webPage->setTabId(tabId);
+#if DEBUG_LOGS
+    qDebug() << "claimed spare page:" << webPage->uniqueID() << "for tab:" << tabId << "view ready:" << webPage->viewReady();
+#endif
+    return webPage;
+}
+
+void WebPages::schedulePreload()
+{
+    if (!m_preloadQueue.isEmpty() && !m_preloadTimer.isActive()) {
+        m_preloadTimer.start();
+    }
+}
+
+void WebPages::preloadNext()
+{
+    // One page at a time.
+    if (m_preloadingPage || !initialized()) {
+        return;
+    }
+
+    if (m_memoryLevel != NormalMemory || m_activePages.count() >= m_activePages.maxLivePages()) {
+        m_preloadQueue.clear();
+        return;
+    }
+
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    if (!activePage) {
+        return;
+    }
+
+    // Active page goes first. Continue once it has loaded.
+    if (activePage->loading()) {
+        connect(activePage, SIGNAL(loadingChanged()), this, SLOT(schedulePreload()), Qt::UniqueConnection);
+        return;
+    }
+
+    while (!m_preloadQueue.isEmpty()) {
+        Tab tab = m_preloadQueue.takeFirst();
+        if (m_activePages.alive(tab.tabId()) || tab.url().isEmpty()) {
+            continue;
+        }
+
+        DeclarativeWebPage *webPage = createPage(tab.tabId(), 0);
+        if (webPage) {
+#if DEBUG_LOGS
+            qDebug() << "preloading tab:" << tab.tabId() << tab.url();
+#endif
+            webPage->setVisible(false);
+            webPage->setInitialUrl(tab.url());
+            addToOpenerGraph(tab.tabId(), webPage);
+            m_activePages.append(tab.tabId(), webPage);
+            m_preloadingPage = webPage;
+            updateIdleSweep();
+            connect(webPage, SIGNAL(loadingChanged()), this, SLOT(onPreloadLoadingChanged()));
+        }
+        break;
+    }
+}
+
+void WebPages::onPreloadLoadingChanged()
+{
+    DeclarativeWebPage *webPage = qobject_cast<DeclarativeWebPage *>(sender());
+    if (!webPage || webPage->loading() || webPage->url().isEmpty()) {
+        return;
+    }
+
+    disconnect(webPage, SIGNAL(loadingChanged()), this, SLOT(onPreloadLoadingChanged()));
+    // Keep the page fetched but idle until the user activates it.
+    if (!m_activePages.active(webPage->tabId())) {
+        m_activePages.suspend(webPage->tabId());
+    }
+
+    if (m_preloadingPage == webPage) {
+        m_preloadingPage = 0;
+    }
+    schedulePreload();
+}
+
+void WebPages::sweepIdlePages()
+{
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    if (!activePage) {
+        return;
+    }
+
+    m_activePages.sweepIdlePages(m_idleSuspendAge, m_idleVirtualizeAge, m_idleDiscardAge,
+                                 relatedTabIds(activePage->tabId()));
+    scheduleTeardown();
+    updateIdleSweep();
+}
+
+void WebPages::updateIdleSweep()
+{
+    if (!m_activePages.hasIdlePages()) {
+        m_idleSweepTimer.stop();
+    } else if (!m_idleSweepTimer.isActive()) {
+        m_idleSweepTimer.start();
+    }
+}
+
+void WebPages::onPageStateChanged()
+{
+    DeclarativeWebPage *webPage = qobject_cast<DeclarativeWebPage *>(sender());
+    if (webPage) {
+        disconnect(webPage, SIGNAL(pageStateChanged()), this, SLOT(onPageStateChanged()));
+        m_activePages.pageStateReceived(webPage->tabId());
+        scheduleTeardown();
+    }
+}
+
+void WebPages::expirePageStateRequests()
+{
+    m_activePages.expirePageStateRequests();
+    scheduleTeardown();
+}
+
+void WebPages::scheduleTeardown()
+{
+    m_releasedPages.append(m_activePages.takeReleasedPages());
+    if (!m_releasedPages.isEmpty() && !m_teardownTimer.isActive()) {
+        m_teardownDeferrals = 0;
+        m_teardownTimer.start();
+    }
+}
+
+/**
+ * Destroys all released pages right away. Use when memory is needed now.
+ */
+void WebPages::flushTeardown()
+{
+    m_teardownTimer.stop();
+    m_releasedPages.append(m_activePages.takeReleasedPages());
+    while (!m_releasedPages.isEmpty()) {
+        DeclarativeWebPage *webPage = m_releasedPages.takeFirst();
+        webPage->setParent(0);
+        delete webPage;
+    }
+}
+
+void WebPages::teardownReleasedPage()
+{
+    if (m_releasedPages.isEmpty()) {
+        return;
+    }
+
+    // Don't compete with the first paint of a newly activated page.
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    if (activePage && !activePage->isPainted() && m_webContainer && m_webContainer->foreground()
+            && m_teardownDeferrals < gMaxTeardownDeferrals) {
+        ++m_teardownDeferrals;
+        m_teardownTimer.start();
+        return;
+    }
+
+    DeclarativeWebPage *webPage = m_releasedPages.takeFirst();
+#if DEBUG_LOGS
+    qDebug() << "destroying released page:" << webPage << "remaining:" << m_releasedPages.count();
+#endif
+    webPage->setParent(0);
+    delete webPage;
+
+    if (!m_releasedPages.isEmpty()) {
+        m_teardownTimer.start();
+    }
+}
+
+void WebPages::releaseSparePages(int keepCount)
+{
+    m_spareTimer.stop();
+    while (m_sparePages.count() > keepCount) {
+        DeclarativeWebPage *webPage = m_sparePages.takeLast();
+        if (webPage->viewReady()) {
+            webPage->setParent(0);
+            delete webPage;
+        } else {
+            connect(webPage, SIGNAL(viewReadyChanged()), webPage, SLOT(deleteLater()));
+        }
+    }
+}
+
+void WebPages::scheduleSparePages()
+{
+    if (m_sparePages.count() < m_maxSparePages && !m_spareTimer.isActive()) {
+        m_spareTimer.start();
+    }
+}
+
+void WebPages::fillSparePages()
+{
+    // Only fill when there is an active page, the browser is in foreground
+    // and no memory pressure has been signaled.
+    if (!initialized() || !m_webContainer->foreground() || !m_activePages.activeWebPage()
+            || m_memoryLevel != NormalMemory || m_sparePages.count() >= m_maxSparePages) {
+        return;
+    }
+
+    DeclarativeWebPage *webPage = createPage(0, 0);
+    if (webPage) {
+        webPage->setVisible(false);
+        m_sparePages.append(webPage);
+        // Create rest of the spare pages one by one at idle.
+        scheduleSparePages();
+    }
 }
 
 void WebPages::updateStates(DeclarativeWebPage *oldActivePage, DeclarativeWebPage *newActivePage)
@@ -173,38 +601,241 @@ void WebPages::updateStates(DeclarativeWebPage *oldActivePage, DeclarativeWebPag
         oldActivePage->setOpacity(1.0);
 
         // Allow suspending only the current active page if it is not the creator (parent).
-        if (newActivePage->parentId() != (int)oldActivePage->uniqueID()) {
+        if (parentTabId(newActivePage->tabId()) != oldActivePage->tabId()) {
             if (oldActivePage->loading()) {
                 oldActivePage->stop();
             }
-            oldActivePage->suspendView();
+            m_activePages.suspend(oldActivePage->tabId());
         }
     }
 
     if (newActivePage) {
+        WebPageTrace::instance()->record(WebPageTrace::Resume, newActivePage->tabId());
         newActivePage->resumeView();
         newActivePage->setVisible(true);
     }
 }
 
+void WebPages::addToOpenerGraph(int tabId, DeclarativeWebPage *webPage)
+{
+    quint32 viewId = webPage->uniqueID();
+    m_viewIdToTabId.remove(m_tabIdToViewId.value(tabId));
+    m_tabIdToViewId.insert(tabId, viewId);
+    m_viewIdToTabId.insert(viewId, tabId);
+
+    // Resurrected pages are created without a parent view, the edge is
+    // already in place for them.
+    int openerTabId = m_viewIdToTabId.value(webPage->parentId());
+    if (openerTabId > 0 && !m_openers.contains(tabId)) {
+        m_openers.insert(tabId, openerTabId);
+        m_children.insert(openerTabId, tabId);
+    }
+}
+
+void WebPages::removeFromOpenerGraph(int tabId)
+{
+    m_viewIdToTabId.remove(m_tabIdToViewId.take(tabId));
+
+    int openerTabId = m_openers.take(tabId);
+    if (openerTabId > 0) {
+        m_children.remove(openerTabId, tabId);
+    }
+
+    foreach (int childTabId, m_children.values(tabId)) {
+        m_openers.remove(childTabId);
+    }
+    m_children.remove(tabId);
+}
+
+/**
+ * Returns opener and children of \a tabId. These are kept alive together with
+ * the tab when pages are virtualized.
+ */
+QSet<int> WebPages::relatedTabIds(int tabId) const
+{
+    QSet<int> tabIds = QSet<int>::fromList(m_children.values(tabId));
+    if (m_openers.contains(tabId)) {
+        tabIds.insert(m_openers.value(tabId));
+    }
+    return tabIds;
+}
+
+/**
+ * Records the first paint of a newly activated page to the trace. A page that
+ * has already painted is considered painted on the next frame.
+ */
+void WebPages::tracePaint(DeclarativeWebPage *webPage)
+{
+    if (!webPage->isPainted()) {
+        connect(webPage, SIGNAL(firstPaint(int,int)), this, SLOT(onFirstPaint()), Qt::UniqueConnection);
+    } else if (m_webContainer && m_webContainer->window()) {
+        connect(m_webContainer->window(), SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()), Qt::UniqueConnection);
+    }
+}
+
+void WebPages::onFirstPaint()
+{
+    DeclarativeWebPage *webPage = qobject_cast<DeclarativeWebPage *>(sender());
+    if (webPage) {
+        disconnect(webPage, SIGNAL(firstPaint(int,int)), this, SLOT(onFirstPaint()));
+        WebPageTrace::instance()->painted(webPage->tabId());
+    }
+}
+
+void WebPages::onFrameSwapped()
+{
+    disconnect(sender(), SIGNAL(frameSwapped()), this, SLOT(onFrameSwapped()));
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    if (activePage) {
+        WebPageTrace::instance()->painted(activePage->tabId());
+    }
+}
+
 void WebPages::dumpPages() const
 {
     m_activePages.dumpPages();
+    WebPageTrace::instance()->dump();
+}
+
+/**
+ * Registers a stage to the memory pressure pipeline. Stages are run in the
+ * registration order, one stage per round, for as long as memory level stays at
+ * or above \a minimumLevel. The pipeline stops at the first stage above the
+ * current level and continues from it if the level rises, so stages need to be
+ * registered in the order of their \a minimumLevel. The \a method is a slot of
+ * the \a receiver that returns true if the stage can be run again during the
+ * same memory pressure.
+ */
+void WebPages::addMemoryPressureStage(const QString &name, MemoryLevel minimumLevel, QObject *receiver, const char *method)
+{
+    MemoryPressureStage stage;
+    stage.name = name;
+    stage.minimumLevel = minimumLevel;
+    stage.receiver = receiver;
+    stage.method = method;
+    m_memoryPressureStages.append(stage);
 }
 
 void WebPages::handleMemNotify(const QString &memoryLevel)
 {
+    if (memoryLevel == QString("critical")) {
+        m_memoryLevel = CriticalMemory;
+    } else if (memoryLevel == QString("warning")) {
+        m_memoryLevel = WarningMemory;
+    } else {
+        m_memoryLevel = NormalMemory;
+    }
+
     if (!m_webContainer || !m_webContainer->completed()) {
         return;
     }
 
-    if (memoryLevel == QString("warning") || memoryLevel == QString("critical")) {
-        m_activePages.virtualizeInactive();
+    if (m_memoryLevel == NormalMemory) {
+        m_memoryPressureTimer.stop();
+        m_memoryPressureStage = 0;
+        if (m_databaseCacheShrunk) {
+            DBManager::instance()->setCacheSize(gDefaultDatabaseCacheSize);
+            m_databaseCacheShrunk = false;
+        }
+        scheduleSparePages();
+    } else {
+        m_preloadTimer.stop();
+        m_preloadQueue.clear();
+        releaseSparePages();
+        runMemoryPressureStage();
+    }
+}
+
+void WebPages::runMemoryPressureStage()
+{
+    if (m_memoryLevel == NormalMemory) {
+        return;
+    }
 
-        if (!m_webContainer->foreground() &&
-                (QDateTime::currentMSecsSinceEpoch() - m_backgroundTimestamp) > gMemoryPressureTimeout) {
-            m_backgroundTimestamp = QDateTime::currentMSecsSinceEpoch();
-            QMozContext::GetInstance()->sendObserve(QString("memory-pressure"), QString("heap-minimize"));
+    while (m_memoryPressureStage < m_memoryPressureStages.count()) {
+        const MemoryPressureStage &stage = m_memoryPressureStages.at(m_memoryPressureStage);
+        if (!stage.receiver) {
+            ++m_memoryPressureStage;
+            continue;
         }
+
+        // Stages of a higher level wait here in case memory level rises.
+        if (stage.minimumLevel > m_memoryLevel) {
+            return;
+        }
+
+        // Memory released by the engine is returned asynchronously. The value
+        // logged here is what the process had released when the stage returned.
+        qint64 residentBefore = residentMemory();
+        bool repeat = false;
+        QMetaObject::invokeMethod(stage.receiver, stage.method.constData(), Qt::DirectConnection,
+                                  Q_RETURN_ARG(bool, repeat));
+        if (m_memoryLevel == CriticalMemory) {
+            flushTeardown();
+        }
+        qDebug() << "Memory pressure stage" << stage.name << "level:" << m_memoryLevel
+                 << "freed:" << (residentBefore - residentMemory()) / 1024 << "kB";
+
+        if (!repeat) {
+            ++m_memoryPressureStage;
+        }
+        break;
+    }
+
+    if (m_memoryPressureStage < m_memoryPressureStages.count()) {
+        m_memoryPressureTimer.start(m_memoryLevel == CriticalMemory ? gCriticalStageInterval : gWarningStageInterval);
+    }
+}
+
+bool WebPages::releaseImageCaches()
+{
+    QPixmapCache::clear();
+    ThumbnailCache::instance()->clearMemory();
+    IconStore::instance()->clearMemory();
+    if (m_webContainer && m_webContainer->window()) {
+        m_webContainer->window()->releaseResources();
+    }
+    return false;
+}
+
+bool WebPages::shrinkDatabaseCache()
+{
+    if (!m_databaseCacheShrunk) {
+        DBManager::instance()->setCacheSize(gLowMemoryDatabaseCacheSize);
+        m_databaseCacheShrunk = true;
+    }
+    return false;
+}
+
+bool WebPages::minimizeHeap()
+{
+    // heap-minimize is process wide and stalls also the active page. In foreground
+    // send it only when memory level is critical.
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if ((m_webContainer->foreground() && m_memoryLevel != CriticalMemory)
+            || now - m_heapMinimizeTimestamp < gHeapMinimizeInterval) {
+        return false;
+    }
+
+    m_heapMinimizeTimestamp = now;
+    QMozContext::GetInstance()->sendObserve(QString("memory-pressure"), QString("heap-minimize"));
+    return false;
+}
+
+bool WebPages::virtualizeLeastRecentlyUsed()
+{
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    bool virtualized = activePage && m_activePages.virtualizeLeastRecentlyUsed(relatedTabIds(activePage->tabId()));
+    scheduleTeardown();
+    return virtualized;
+}
+
+bool WebPages::virtualizeInactive()
+{
+    DeclarativeWebPage *activePage = m_activePages.activeWebPage();
+    if (activePage) {
+        m_activePages.virtualizeInactive(relatedTabIds(activePage->tabId()));
     }
+    scheduleTeardown();
+    return false;
 }
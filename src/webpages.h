@@ -13,9 +13,15 @@
 #define WEBPAGES_H
 
 #include "webpagequeue.h"
+#include "tab.h"
 
 #include <QObject>
 #include <QPointer>
+#include <QTimer>
+#include <QList>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
 
 class QQmlComponent;
 class DeclarativeWebContainer;
@@ -36,6 +42,12 @@ class WebPages : public QObject
     Q_OBJECT
 
 public:
+    enum MemoryLevel {
+        NormalMemory,
+        WarningMemory,
+        CriticalMemory
+    };
+
     explicit WebPages(QObject *parent = 0);
     ~WebPages();
 
@@ -46,26 +58,113 @@ public:
     bool setMaxLivePages(int count);
     int maxLivePages() const;
 
+    bool setMaxSparePages(int count);
+    int maxSparePages() const;
+
+    bool setMaxPreloadPages(int count);
+    int maxPreloadPages() const;
+    void preload(const QList<Tab> &tabs);
+
     bool alive(int tabId) const;
 
     WebPageActivationData page(int tabId, int parentId = 0);
     void release(int tabId, bool virtualize = false);
     void clear();
     int parentTabId(int tabId) const;
+    QList<int> childTabIds(int tabId) const;
     void dumpPages() const;
 
+    void addMemoryPressureStage(const QString &name, MemoryLevel minimumLevel, QObject *receiver, const char *method);
+
 private slots:
     void handleMemNotify(const QString &memoryLevel);
-    void updateBackgroundTimestamp();
+    void handleForegroundChanged();
+    void fillSparePages();
+    void runMemoryPressureStage();
+    void teardownReleasedPage();
+    void sweepIdlePages();
+    void schedulePreload();
+    void preloadNext();
+    void onPreloadLoadingChanged();
+    void onPageStateChanged();
+    void expirePageStateRequests();
+    void onFirstPaint();
+    void onFrameSwapped();
+
+    // Memory pressure stages. Return true when the stage can be run again.
+    bool releaseImageCaches();
+    bool shrinkDatabaseCache();
+    bool minimizeHeap();
+    bool virtualizeLeastRecentlyUsed();
+    bool virtualizeInactive();
 
 private:
+    struct MemoryPressureStage {
+        QString name;
+        MemoryLevel minimumLevel;
+        QPointer<QObject> receiver;
+        QByteArray method;
+    };
+
+    DeclarativeWebPage *createPage(int tabId, int parentId);
+    DeclarativeWebPage *takeSparePage(int tabId);
+    void releaseSparePages(int keepCount = 0);
+    void scheduleSparePages();
+    void scheduleTeardown();
+    void flushTeardown();
+    void updateIdleSweep();
     void updateStates(DeclarativeWebPage *oldActivePage, DeclarativeWebPage *newActivePage);
+    void tracePaint(DeclarativeWebPage *webPage);
+    void addToOpenerGraph(int tabId, DeclarativeWebPage *webPage);
+    void removeFromOpenerGraph(int tabId);
+    QSet<int> relatedTabIds(int tabId) const;
 
     QPointer<DeclarativeWebContainer> m_webContainer;
     QPointer<QQmlComponent> m_webPageComponent;
     // Contains both virtual and real
     WebPageQueue m_activePages;
-    qint64 m_backgroundTimestamp;
+    // Pre-created pages that are not yet bound to any tab. Claimed by page()
+    // when a new tab without a parent is opened.
+    QList<DeclarativeWebPage *> m_sparePages;
+    int m_maxSparePages;
+    QTimer m_spareTimer;
+
+    // Opener graph. Views change when pages are virtualized and resurrected,
+    // opener edges between tabs stay until either of the tabs is closed.
+    QHash<int, quint32> m_tabIdToViewId;
+    QHash<quint32, int> m_viewIdToTabId;
+    QHash<int, int> m_openers;
+    QMultiHash<int, int> m_children;
+
+    // Tabs of the previous session loaded in background one at a time after
+    // the active tab, most recently used first.
+    QList<Tab> m_preloadQueue;
+    QPointer<DeclarativeWebPage> m_preloadingPage;
+    int m_maxPreloadPages;
+    QTimer m_preloadTimer;
+
+    // Inactive pages are suspended, virtualized and discarded to disk
+    // based on how long they have been inactive. Ages in milliseconds.
+    QTimer m_idleSweepTimer;
+    qint64 m_idleSuspendAge;
+    qint64 m_idleVirtualizeAge;
+    qint64 m_idleDiscardAge;
+
+    // Deactivated pages wait for their page state before they can be virtualized.
+    QTimer m_pageStateTimer;
+
+    // Released pages are destroyed one per frame once the active page has painted.
+    QList<DeclarativeWebPage *> m_releasedPages;
+    QTimer m_teardownTimer;
+    int m_teardownDeferrals;
+
+    // Memory pressure stages in the order they are run.
+    QList<MemoryPressureStage> m_memoryPressureStages;
+    int m_memoryPressureStage;
+    QTimer m_memoryPressureTimer;
+    MemoryLevel m_memoryLevel;
+    bool m_databaseCacheShrunk;
+    qint64 m_heapMinimizeTimestamp;
 
     friend class tst_webview;
 };
@@ -0,0 +1,230 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "webpagetrace.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+
+static const int gMaxEvents = 1024;
+static const int gMaxLatencySamples = 256;
+
+static const char *eventName(WebPageTrace::EventType type)
+{
+    switch (type) {
+    case WebPageTrace::Create: return "create";
+    case WebPageTrace::ViewInitialized: return "viewInitialized";
+    case WebPageTrace::Activate: return "activate";
+    case WebPageTrace::Suspend: return "suspend";
+    case WebPageTrace::Resume: return "resume";
+    case WebPageTrace::Virtualize: return "virtualize";
+    case WebPageTrace::Resurrect: return "resurrect";
+    case WebPageTrace::Delete: return "delete";
+    case WebPageTrace::FirstPaint: return "firstPaint";
+    }
+    return "unknown";
+}
+
+static const char *transitionName(WebPageTrace::Transition transition)
+{
+    switch (transition) {
+    case WebPageTrace::NoTransition: return "none";
+    case WebPageTrace::LiveTransition: return "live";
+    case WebPageTrace::SpareTransition: return "spare";
+    case WebPageTrace::NewTransition: return "new";
+    case WebPageTrace::ResurrectTransition: return "resurrect";
+    }
+    return "unknown";
+}
+
+WebPageTrace::Event::Event()
+    : timestamp(0)
+    , type(Create)
+    , transition(NoTransition)
+    , tabId(0)
+    , duration(0)
+{
+}
+
+WebPageTrace *WebPageTrace::instance()
+{
+    static WebPageTrace *webPageTrace;
+    if (!webPageTrace)
+        webPageTrace = new WebPageTrace();
+    return webPageTrace;
+}
+
+WebPageTrace::WebPageTrace(QObject *parent)
+    : QObject(parent)
+    , m_events(gMaxEvents)
+    , m_next(0)
+    , m_wrapped(false)
+    , m_pendingTabId(0)
+    , m_pendingTimestamp(0)
+    , m_pendingTransition(NoTransition)
+{
+    m_clock.start();
+}
+
+void WebPageTrace::record(EventType type, int tabId, Transition transition)
+{
+    Event &event = m_events[m_next];
+    event.timestamp = m_clock.nsecsElapsed() / 1000;
+    event.type = type;
+    event.transition = transition;
+    event.tabId = tabId;
+    event.duration = 0;
+
+    if (++m_next == gMaxEvents) {
+        m_next = 0;
+        m_wrapped = true;
+    }
+}
+
+/**
+ * Records activation of a tab. Latency to the next painted() call of the same
+ * tab is accounted to the \a transition.
+ */
+void WebPageTrace::activated(int tabId, Transition transition)
+{
+    record(Activate, tabId, transition);
+    m_pendingTabId = tabId;
+    m_pendingTimestamp = m_events.at((m_next + gMaxEvents - 1) % gMaxEvents).timestamp;
+    m_pendingTransition = transition;
+}
+
+void WebPageTrace::painted(int tabId)
+{
+    if (tabId == 0 || tabId != m_pendingTabId) {
+        return;
+    }
+
+    record(FirstPaint, tabId, m_pendingTransition);
+    Event &event = m_events[(m_next + gMaxEvents - 1) % gMaxEvents];
+    event.duration = event.timestamp - m_pendingTimestamp;
+
+    QList<qint64> &latencies = m_latencies[m_pendingTransition];
+    latencies.append(event.duration);
+    if (latencies.count() > gMaxLatencySamples) {
+        latencies.removeFirst();
+    }
+    m_pendingTabId = 0;
+}
+
+QList<WebPageTrace::Event> WebPageTrace::events() const
+{
+    QList<Event> events;
+    int start = m_wrapped ? m_next : 0;
+    int count = m_wrapped ? gMaxEvents : m_next;
+    for (int i = 0; i < count; ++i) {
+        events.append(m_events.at((start + i) % gMaxEvents));
+    }
+    return events;
+}
+
+/**
+ * Returns the given \a percentile of activation to paint latencies of
+ * \a transition in microseconds, or -1 if there are no samples.
+ */
+qint64 WebPageTrace::percentile(Transition transition, int percentile) const
+{
+    QList<qint64> latencies = m_latencies.value(transition);
+    if (latencies.isEmpty()) {
+        return -1;
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    int index = qBound(0, (latencies.count() * percentile + 99) / 100 - 1, latencies.count() - 1);
+    return latencies.at(index);
+}
+
+/**
+ * Returns recorded events in Chrome trace event format. The output can be loaded
+ * to chrome://tracing. Each tab is shown as its own thread.
+ */
+QByteArray WebPageTrace::chromeTrace() const
+{
+    QJsonArray traceEvents;
+    qint64 pid = QCoreApplication::applicationPid();
+    QList<Event> recordedEvents = events();
+    for (int i = 0; i < recordedEvents.count(); ++i) {
+        const Event &event = recordedEvents.at(i);
+        QJsonObject traceEvent;
+        traceEvent.insert("name", QString(eventName(event.type)));
+        traceEvent.insert("cat", QString("tab"));
+        traceEvent.insert("pid", pid);
+        traceEvent.insert("tid", event.tabId);
+
+        QJsonObject args;
+        args.insert("transition", QString(transitionName(event.transition)));
+        traceEvent.insert("args", args);
+
+        if (event.type == FirstPaint) {
+            // Complete event spanning from activation to paint.
+            traceEvent.insert("ph", QString("X"));
+            traceEvent.insert("ts", event.timestamp - event.duration);
+            traceEvent.insert("dur", event.duration);
+        } else {
+            traceEvent.insert("ph", QString("i"));
+            traceEvent.insert("s", QString("t"));
+            traceEvent.insert("ts", event.timestamp);
+        }
+        traceEvents.append(traceEvent);
+    }
+
+    QJsonObject trace;
+    trace.insert("traceEvents", traceEvents);
+    trace.insert("displayTimeUnit", QString("ms"));
+    return QJsonDocument(trace).toJson(QJsonDocument::Compact);
+}
+
+bool WebPageTrace::writeChromeTrace(QString fileName)
+{
+    if (fileName.isEmpty()) {
+        fileName = QString("/tmp/sailfish-browser-trace-%1.json").arg(QCoreApplication::applicationPid());
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "Cannot write tab trace to" << fileName;
+        return false;
+    }
+
+    file.write(chromeTrace());
+    return true;
+}
+
+void WebPageTrace::dump() const
+{
+    qDebug() << "---- trace ----";
+    QList<Event> recordedEvents = events();
+    for (int i = 0; i < recordedEvents.count(); ++i) {
+        const Event &event = recordedEvents.at(i);
+        qDebug() << event.timestamp << "tabId:" << event.tabId << eventName(event.type)
+                 << transitionName(event.transition) << event.duration;
+    }
+
+    for (int transition = LiveTransition; transition <= ResurrectTransition; ++transition) {
+        qint64 p50 = percentile((Transition)transition, 50);
+        if (p50 >= 0) {
+            qDebug() << "activation to paint" << transitionName((Transition)transition)
+                     << "p50:" << p50 / 1000.0 << "ms p95:" << percentile((Transition)transition, 95) / 1000.0 << "ms"
+                     << "samples:" << m_latencies.value(transition).count();
+        }
+    }
+    qDebug() << "---- end ------";
+}
@@ -0,0 +1,89 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef WEBPAGETRACE_H
+#define WEBPAGETRACE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+class WebPageTrace : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum EventType {
+        Create,
+        ViewInitialized,
+        Activate,
+        Suspend,
+        Resume,
+        Virtualize,
+        Resurrect,
+        Delete,
+        FirstPaint
+    };
+
+    // How the page was obtained when a tab got activated.
+    enum Transition {
+        NoTransition,
+        LiveTransition,
+        SpareTransition,
+        NewTransition,
+        ResurrectTransition
+    };
+
+    struct Event {
+        Event();
+
+        qint64 timestamp; // Microseconds, monotonic
+        EventType type;
+        Transition transition;
+        int tabId;
+        qint64 duration; // Microseconds, activation to paint for FirstPaint
+    };
+
+    static WebPageTrace *instance();
+
+    void record(EventType type, int tabId, Transition transition = NoTransition);
+    void activated(int tabId, Transition transition);
+    void painted(int tabId);
+
+    QList<Event> events() const;
+    qint64 percentile(Transition transition, int percentile) const;
+    QByteArray chromeTrace() const;
+
+    void dump() const;
+
+public slots:
+    bool writeChromeTrace(QString fileName);
+
+private:
+    explicit WebPageTrace(QObject *parent = 0);
+
+    QElapsedTimer m_clock;
+    QVector<Event> m_events;
+    int m_next;
+    bool m_wrapped;
+
+    // Activation waiting for the first paint of the tab.
+    int m_pendingTabId;
+    qint64 m_pendingTimestamp;
+    Transition m_pendingTransition;
+
+    // Activation to paint latencies per transition, latest samples last.
+    QHash<int, QList<qint64> > m_latencies;
+};
+
+#endif
@@ -1,12 +1,18 @@
 # TODO: Change this to subdirs once we get first C++ test
 TEMPLATE = subdirs
 
-SUBDIRS += tst_dbmanager \
+SUBDIRS += tst_blackframe \
+    tst_dbmanager \
     tst_declarativebookmarkmodel \
     tst_declarativehistorymodel \
     tst_declarativetabmodel \
     tst_desktopbookmarkwriter \
+    tst_iconstore \
     tst_linkvalidator \
+    tst_preconnector \
+    tst_suggestionengine \
+    tst_tab \
+    tst_thumbnailcache \
     tst_webview
 
 OTHER_FILES += \
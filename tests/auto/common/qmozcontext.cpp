@@ -0,0 +1,46 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "qmozcontext.h"
+
+QMozContext *QMozContext::GetInstance()
+{
+    static QMozContext *mozContext;
+    if (!mozContext)
+        mozContext = new QMozContext();
+    return mozContext;
+}
+
+QMozContext::QMozContext(QObject *parent)
+    : QObject(parent)
+    , m_initialized(true)
+{
+}
+
+bool QMozContext::initialized() const
+{
+    return m_initialized;
+}
+
+void QMozContext::setInitialized(bool initialized)
+{
+    if (m_initialized != initialized) {
+        m_initialized = initialized;
+        if (m_initialized) {
+            emit onInitialized();
+        }
+    }
+}
+
+void QMozContext::sendObserve(const QString &aTopic, const QVariant &value)
+{
+    observed.append(qMakePair(aTopic, value));
+}
@@ -0,0 +1,47 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef QMOZCONTEXT_H
+#define QMOZCONTEXT_H
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVariant>
+
+// Mock of QMozContext. Records observer notifications instead of
+// sending them to the engine.
+class QMozContext : public QObject
+{
+    Q_OBJECT
+
+public:
+    static QMozContext *GetInstance();
+
+    bool initialized() const;
+    void setInitialized(bool initialized);
+
+    void sendObserve(const QString &aTopic, const QVariant &value);
+
+    QList<QPair<QString, QVariant> > observed;
+
+signals:
+    void onInitialized();
+    void recvObserve(const QString message, const QVariant data);
+
+private:
+    explicit QMozContext(QObject *parent = 0);
+
+    bool m_initialized;
+};
+
+#endif // QMOZCONTEXT_H
@@ -0,0 +1,7 @@
+# Mock interface for QMozContext. Interface is not complete.
+# Currently it includes only methods needed at runtime.
+# This pri is included indirectly from unit tests cases that
+# are at the same level in the file hierarchy.
+INCLUDEPATH += $$PWD
+SOURCES += ../common/qmozcontext.cpp
+HEADERS += ../common/qmozcontext.h
@@ -0,0 +1,184 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QImage>
+
+#include "blackframe.h"
+
+// Thumbnail grab size of a portrait page.
+static const int gWidth = 540;
+static const int gHeight = 960;
+
+// Per channel scan that was used before the vectorized one, kept as the
+// baseline of the benchmarks.
+static bool referenceAllBlack(const QImage &image)
+{
+    for (int j = 0; j < image.height(); ++j) {
+        const QRgb *b = (const QRgb *)image.constScanLine(j);
+        for (int i = 0; i < image.width(); ++i) {
+            if (qRed(b[i]) != 0 || qGreen(b[i]) != 0 || qBlue(b[i]) != 0)
+                return false;
+        }
+    }
+    return true;
+}
+
+class tst_blackframe : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_blackframe(QObject *parent = 0);
+
+private slots:
+    void allBlack_data();
+    void allBlack();
+    void formats();
+
+    void benchmarkBlack_data();
+    void benchmarkBlack();
+    void benchmarkContent_data();
+    void benchmarkContent();
+
+private:
+    QImage blackImage(int width = gWidth, int height = gHeight) const;
+    void addBenchmarkColumns();
+};
+
+tst_blackframe::tst_blackframe(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QImage tst_blackframe::blackImage(int width, int height) const
+{
+    QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+    image.fill(qRgba(0, 0, 0, 255));
+    return image;
+}
+
+void tst_blackframe::allBlack_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("x");
+    QTest::addColumn<int>("y");
+    QTest::addColumn<QRgb>("pixel");
+    QTest::addColumn<bool>("expected");
+
+    QTest::newRow("black") << gWidth << -1 << -1 << QRgb(0) << true;
+    QTest::newRow("transparent") << gWidth << 10 << 10 << qRgba(0, 0, 0, 0) << true;
+    QTest::newRow("red") << gWidth << 0 << 0 << qRgb(1, 0, 0) << false;
+    QTest::newRow("green") << gWidth << 17 << 300 << qRgb(0, 1, 0) << false;
+    QTest::newRow("blue") << gWidth << gWidth - 1 << gHeight - 1 << qRgb(0, 0, 1) << false;
+    // Odd widths exercise the tails of the vector loops.
+    QTest::newRow("tail of 16") << 547 << 543 << 5 << qRgb(0, 0, 1) << false;
+    QTest::newRow("tail of 4") << 547 << 546 << 5 << qRgb(1, 0, 0) << false;
+    QTest::newRow("narrow") << 3 << 2 << 900 << qRgb(0, 1, 0) << false;
+    QTest::newRow("narrow black") << 3 << -1 << -1 << QRgb(0) << true;
+}
+
+void tst_blackframe::allBlack()
+{
+    QFETCH(int, width);
+    QFETCH(int, x);
+    QFETCH(int, y);
+    QFETCH(QRgb, pixel);
+    QFETCH(bool, expected);
+
+    QImage image = blackImage(width);
+    if (x >= 0) {
+        image.setPixel(x, y, pixel);
+    }
+
+    QCOMPARE(::allBlack(image, FullCheck), expected);
+    QCOMPARE(::allBlack(image, SampledCheck), expected);
+    QCOMPARE(referenceAllBlack(image), expected);
+}
+
+void tst_blackframe::formats()
+{
+    QImage image(64, 64, QImage::Format_RGB16);
+    image.fill(Qt::black);
+    QVERIFY(::allBlack(image));
+    image.setPixel(63, 63, qRgb(255, 255, 255));
+    QVERIFY(!::allBlack(image));
+
+    image = blackImage().convertToFormat(QImage::Format_RGB32);
+    QVERIFY(::allBlack(image));
+    QVERIFY(::allBlack(QImage()));
+}
+
+void tst_blackframe::addBenchmarkColumns()
+{
+    QTest::addColumn<int>("method");
+
+    QTest::newRow("reference") << -1;
+    QTest::newRow("full") << int(FullCheck);
+    QTest::newRow("sampled") << int(SampledCheck);
+}
+
+void tst_blackframe::benchmarkBlack_data()
+{
+    addBenchmarkColumns();
+}
+
+// Worst case, every pixel is visited.
+void tst_blackframe::benchmarkBlack()
+{
+    QFETCH(int, method);
+    QImage image = blackImage();
+    bool black = false;
+
+    if (method < 0) {
+        QBENCHMARK {
+            black = referenceAllBlack(image);
+        }
+    } else {
+        QBENCHMARK {
+            black = ::allBlack(image, (BlackFrameCheck)method);
+        }
+    }
+    QVERIFY(black);
+}
+
+void tst_blackframe::benchmarkContent_data()
+{
+    addBenchmarkColumns();
+}
+
+// Page with black upper half, content is found half way through the scan.
+void tst_blackframe::benchmarkContent()
+{
+    QFETCH(int, method);
+    QImage image = blackImage();
+    for (int y = gHeight / 2; y < gHeight; ++y) {
+        QRgb *line = (QRgb *)image.scanLine(y);
+        for (int x = 0; x < gWidth; ++x) {
+            line[x] = qRgb(255, 255, 255);
+        }
+    }
+    bool black = true;
+
+    if (method < 0) {
+        QBENCHMARK {
+            black = referenceAllBlack(image);
+        }
+    } else {
+        QBENCHMARK {
+            black = ::allBlack(image, (BlackFrameCheck)method);
+        }
+    }
+    QVERIFY(!black);
+}
+
+QTEST_MAIN(tst_blackframe)
+#include "tst_blackframe.moc"
@@ -0,0 +1,7 @@
+TARGET = tst_blackframe
+include(../test_common.pri)
+
+SOURCES += tst_blackframe.cpp \
+    ../../../src/blackframe.cpp
+
+HEADERS += ../../../src/blackframe.h
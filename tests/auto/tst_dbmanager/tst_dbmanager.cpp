@@ -30,6 +30,7 @@ private slots:
     void getTabs();
     void updateThumbnailNonBlocking();
     void updateThumbnailBlocking();
+    void bookmarks();
 
     void cleanupTestCase();
 
@@ -107,6 +108,66 @@ void tst_dbmanager::updateThumbnailBlocking()
     }
 }
 
+void tst_dbmanager::bookmarks()
+{
+    DBManager *db = DBManager::instance();
+    QSignalSpy bookmarksAvailableSpy(db, SIGNAL(bookmarksAvailable(QList<Bookmark>)));
+
+    db->addBookmark(Bookmark("Foo", "http://foo", "image://theme/icon-m-foo", true));
+    db->addBookmark(Bookmark("Bar", "http://bar", "", false));
+    db->addBookmark(Bookmark("Baz", "http://baz", "", false));
+    db->editBookmark("http://bar", "http://bar/edited", "Bar edited");
+    db->removeBookmark("http://baz");
+    db->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 1);
+
+    QList<Bookmark> bookmarks = bookmarksAvailableSpy.at(0).at(0).value<QList<Bookmark> >();
+    QCOMPARE(bookmarks.count(), 2);
+    QCOMPARE(bookmarks.at(0).url(), QString("http://foo"));
+    QCOMPARE(bookmarks.at(0).title(), QString("Foo"));
+    QCOMPARE(bookmarks.at(0).favicon(), QString("image://theme/icon-m-foo"));
+    QVERIFY(bookmarks.at(0).hasTouchIcon());
+    QCOMPARE(bookmarks.at(1).url(), QString("http://bar/edited"));
+    QCOMPARE(bookmarks.at(1).title(), QString("Bar edited"));
+
+    // Adding the same url again updates the bookmark in place.
+    QList<Bookmark> imported;
+    imported << Bookmark("Foo 2", "http://foo", "", false) << Bookmark("Qux", "http://qux", "", false);
+    QVERIFY(db->importBookmarks(imported));
+    db->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 2);
+    bookmarks = bookmarksAvailableSpy.at(1).at(0).value<QList<Bookmark> >();
+    QCOMPARE(bookmarks.count(), 3);
+    QCOMPARE(bookmarks.at(0).title(), QString("Foo 2"));
+    QCOMPARE(bookmarks.at(2).url(), QString("http://qux"));
+
+    // foo, bar, qux -> bar, qux, foo
+    db->moveBookmark("http://foo", "http://qux");
+    db->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 3);
+    bookmarks = bookmarksAvailableSpy.at(2).at(0).value<QList<Bookmark> >();
+    QCOMPARE(bookmarks.at(0).url(), QString("http://bar/edited"));
+    QCOMPARE(bookmarks.at(1).url(), QString("http://qux"));
+    QCOMPARE(bookmarks.at(2).url(), QString("http://foo"));
+
+    // Positions stay contiguous after a removal, new bookmarks go last.
+    db->moveBookmark("http://foo", "http://bar/edited");
+    db->removeBookmark("http://bar/edited");
+    db->addBookmark(Bookmark("Quux", "http://quux", "", false));
+    db->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 4);
+    bookmarks = bookmarksAvailableSpy.at(3).at(0).value<QList<Bookmark> >();
+    QCOMPARE(bookmarks.count(), 3);
+    QCOMPARE(bookmarks.at(0).url(), QString("http://foo"));
+    QCOMPARE(bookmarks.at(1).url(), QString("http://qux"));
+    QCOMPARE(bookmarks.at(2).url(), QString("http://quux"));
+
+    db->clearBookmarks();
+    db->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 5);
+    QVERIFY(bookmarksAvailableSpy.at(4).at(0).value<QList<Bookmark> >().isEmpty());
+}
+
 void tst_dbmanager::cleanupTestCase()
 {
     // Wait for event loop of db manager
@@ -18,6 +18,7 @@
 #include "declarativebookmarkmodel.h"
 #include "testobject.h"
 #include "bookmarkmanager.h"
+#include "dbmanager.h"
 
 static const QByteArray QML_SNIPPET = \
         "import QtQuick 2.0\n" \
@@ -44,9 +45,20 @@ private slots:
     void removeBookmark();
     void contains();
     void editBookmark();
+    void moveBookmark();
     void clearBookmarks();
+    void batchedLoad();
+
+    void benchmarkLoad();
+    void benchmarkData();
+    void benchmarkContains();
+    void benchmarkMove();
 
 private:
+    QList<Bookmark> manyBookmarks() const;
+    QStringList urls() const;
+    void setBookmarks(const QList<Bookmark> &bookmarks);
+
     DeclarativeBookmarkModel *bookmarkModel;
 };
 
@@ -61,8 +73,10 @@ void tst_declarativebookmarkmodel::initTestCase()
 {
     QVERIFY(bookmarkModel);
 
-    // Preload bookmarks
+    // Preload bookmarks, imported to the database on first load
+    QTRY_VERIFY(!bookmarkModel->loading());
     QCOMPARE(bookmarkModel->rowCount(), 5);
+    QVERIFY(!QFile::exists(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json"));
 }
 
 void tst_declarativebookmarkmodel::addBookmark()
@@ -139,10 +153,119 @@ void tst_declarativebookmarkmodel::editBookmark()
     QCOMPARE(count, bookmarkModel->rowCount());
 }
 
+void tst_declarativebookmarkmodel::moveBookmark()
+{
+    bookmarkModel->addBookmark("http://www.test7.jolla.com/1", "jolla1", "");
+    bookmarkModel->addBookmark("http://www.test7.jolla.com/2", "jolla2", "");
+    bookmarkModel->addBookmark("http://www.test7.jolla.com/3", "jolla3", "");
+    int count = bookmarkModel->rowCount();
+
+    QSignalSpy rowsMovedSpy(bookmarkModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    bookmarkModel->moveBookmark(count - 1, count - 3);
+    bookmarkModel->moveBookmark(count - 2, count - 1);
+    QCOMPARE(rowsMovedSpy.count(), 2);
+
+    QStringList expected = urls();
+    QCOMPARE(expected.mid(count - 3), QStringList() << "http://www.test7.jolla.com/3"
+             << "http://www.test7.jolla.com/2" << "http://www.test7.jolla.com/1");
+    QVERIFY(bookmarkModel->contains("http://www.test7.jolla.com/1"));
+
+    // Order is kept in the database.
+    QSignalSpy bookmarksAvailableSpy(DBManager::instance(), SIGNAL(bookmarksAvailable(QList<Bookmark>)));
+    DBManager::instance()->getBookmarks();
+    waitSignals(bookmarksAvailableSpy, 1);
+    QCOMPARE(urls(), expected);
+
+    // Invalid moves are ignored.
+    bookmarkModel->moveBookmark(-1, 0);
+    bookmarkModel->moveBookmark(0, count);
+    QCOMPARE(rowsMovedSpy.count(), 2);
+}
+
+QList<Bookmark> tst_declarativebookmarkmodel::manyBookmarks() const
+{
+    QList<Bookmark> bookmarks;
+    for (int i = 0; i < 5000; ++i) {
+        bookmarks.append(Bookmark(QString("Bookmark %1").arg(i), QString("http://www.jolla.com/%1").arg(i),
+                                  "image://theme/icon-m-service-jolla", false));
+    }
+    return bookmarks;
+}
+
+QStringList tst_declarativebookmarkmodel::urls() const
+{
+    QStringList urls;
+    for (int i = 0; i < bookmarkModel->rowCount(); ++i) {
+        urls << bookmarkModel->data(bookmarkModel->index(i), DeclarativeBookmarkModel::UrlRole).toString();
+    }
+    return urls;
+}
+
+void tst_declarativebookmarkmodel::setBookmarks(const QList<Bookmark> &bookmarks)
+{
+    QMetaObject::invokeMethod(bookmarkModel, "clearBookmarks");
+    QMetaObject::invokeMethod(bookmarkModel, "bookmarksAvailable", Q_ARG(QList<Bookmark>, bookmarks));
+    while (bookmarkModel->loading()) {
+        QCoreApplication::processEvents();
+    }
+}
+
+void tst_declarativebookmarkmodel::benchmarkLoad()
+{
+    QList<Bookmark> bookmarks = manyBookmarks();
+    QBENCHMARK {
+        setBookmarks(bookmarks);
+    }
+    QCOMPARE(bookmarkModel->rowCount(), 5000);
+}
+
+void tst_declarativebookmarkmodel::benchmarkData()
+{
+    setBookmarks(manyBookmarks());
+    int count = bookmarkModel->rowCount();
+    QCOMPARE(count, 5000);
+
+    QBENCHMARK {
+        for (int i = 0; i < count; ++i) {
+            QModelIndex index = bookmarkModel->index(i);
+            bookmarkModel->data(index, DeclarativeBookmarkModel::UrlRole);
+            bookmarkModel->data(index, DeclarativeBookmarkModel::TitleRole);
+            bookmarkModel->data(index, DeclarativeBookmarkModel::FaviconRole);
+            bookmarkModel->data(index, DeclarativeBookmarkModel::TouchIconRole);
+        }
+    }
+}
+
+void tst_declarativebookmarkmodel::benchmarkContains()
+{
+    QList<Bookmark> bookmarks = manyBookmarks();
+    setBookmarks(bookmarks);
+
+    QBENCHMARK {
+        for (int i = 0; i < bookmarks.count(); i += 10) {
+            QVERIFY(bookmarkModel->contains(bookmarks.at(i).url()));
+        }
+    }
+}
+
+void tst_declarativebookmarkmodel::benchmarkMove()
+{
+    setBookmarks(manyBookmarks());
+
+    QBENCHMARK {
+        bookmarkModel->moveBookmark(0, 4999);
+        bookmarkModel->moveBookmark(4999, 0);
+    }
+    QCOMPARE(bookmarkModel->data(bookmarkModel->index(0), DeclarativeBookmarkModel::UrlRole).toString(),
+             QString("http://www.jolla.com/0"));
+
+    QMetaObject::invokeMethod(bookmarkModel, "clearBookmarks");
+}
+
 void tst_declarativebookmarkmodel::cleanupTestCase()
 {
-    QFile file(QStandardPaths::writableLocation(QStandardPaths::DataLocation) + "/bookmarks.json");
-    QVERIFY(file.remove());
+    // Import defaults again on the next run.
+    DBManager::instance()->deleteSetting("bookmarksMigrated");
 }
 
 void tst_declarativebookmarkmodel::clearBookmarks()
@@ -157,6 +280,30 @@ void tst_declarativebookmarkmodel::clearBookmarks()
     QVERIFY(!bookmarkModel->contains("http://www.test6.jolla.com"));
 }
 
+void tst_declarativebookmarkmodel::batchedLoad()
+{
+    QMetaObject::invokeMethod(bookmarkModel, "clearBookmarks");
+    QSignalSpy rowsInsertedSpy(bookmarkModel, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy loadingChangedSpy(bookmarkModel, SIGNAL(loadingChanged()));
+
+    // First rows are available right away, the rest follow from the event loop.
+    QMetaObject::invokeMethod(bookmarkModel, "bookmarksAvailable", Q_ARG(QList<Bookmark>, manyBookmarks()));
+    QVERIFY(bookmarkModel->loading());
+    QCOMPARE(bookmarkModel->rowCount(), 50);
+    QVERIFY(bookmarkModel->contains("http://www.jolla.com/0"));
+
+    // Bookmarks added while loading are not duplicated.
+    bookmarkModel->addBookmark("http://www.jolla.com/4999", "Bookmark 4999", "");
+
+    QTRY_VERIFY(!bookmarkModel->loading());
+    QCOMPARE(bookmarkModel->rowCount(), 5000);
+    QCOMPARE(rowsInsertedSpy.count(), 101);
+    QCOMPARE(loadingChangedSpy.count(), 2);
+    QCOMPARE(urls().last(), QString("http://www.jolla.com/4998"));
+
+    BookmarkManager::instance()->clear();
+}
+
 
 int main(int argc, char *argv[])
 {
@@ -54,6 +54,8 @@ private slots:
     void searchWithSpecialChars_data();
     void searchWithSpecialChars();
 
+    void keyedUpdate();
+
     void cleanupTestCase();
 
 private:
@@ -254,6 +256,63 @@ void tst_declarativehistorymodel::searchWithSpecialChars()
     QCOMPARE(historyModel->rowCount(), expectedCount);
 }
 
+void tst_declarativehistorymodel::keyedUpdate()
+{
+    DeclarativeHistoryModel model;
+    QList<Link> links;
+    links << Link(1, "http://a.com/", "", "A")
+          << Link(2, "http://b.com/", "", "B")
+          << Link(3, "http://c.com/", "", "C")
+          << Link(4, "http://d.com/", "", "D");
+    model.updateModel(links);
+    QCOMPARE(model.rowCount(), 4);
+
+    QSignalSpy insertedSpy(&model, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy removedSpy(&model, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy movedSpy(&model, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)));
+    QSignalSpy dataChangedSpy(&model, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    QSignalSpy resetSpy(&model, SIGNAL(modelReset()));
+
+    links.clear();
+    links << Link(5, "http://e.com/", "", "E")
+          << Link(1, "http://a.com/", "", "A")
+          << Link(3, "http://c.com/", "", "C")
+          << Link(2, "http://b.com/", "", "B changed");
+    model.updateModel(links);
+
+    QCOMPARE(resetSpy.count(), 0);
+    QCOMPARE(removedSpy.count(), 1);
+    QCOMPARE(removedSpy.at(0).at(1).toInt(), 3);
+    QCOMPARE(insertedSpy.count(), 1);
+    QCOMPARE(insertedSpy.at(0).at(1).toInt(), 0);
+    QCOMPARE(movedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.at(0).at(0).value<QModelIndex>().row(), 3);
+
+    QCOMPARE(model.rowCount(), links.count());
+    for (int i = 0; i < links.count(); ++i) {
+        QCOMPARE(model.data(model.index(i), DeclarativeHistoryModel::UrlRole).toString(), links.at(i).url());
+        QCOMPARE(model.data(model.index(i), DeclarativeHistoryModel::TitleRole).toString(), links.at(i).title());
+    }
+
+    // Title updates are looked up by url.
+    dataChangedSpy.clear();
+    model.updateTitle(0, 0, "http://c.com/", "C changed");
+    QCOMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.at(0).at(0).value<QModelIndex>().row(), 2);
+    QCOMPARE(model.data(model.index(2), DeclarativeHistoryModel::TitleRole).toString(), QString("C changed"));
+
+    // Unchanged result set does not touch the rows.
+    dataChangedSpy.clear();
+    insertedSpy.clear();
+    removedSpy.clear();
+    movedSpy.clear();
+    links[2].setTitle("C changed");
+    model.updateModel(links);
+    QCOMPARE(dataChangedSpy.count(), 0);
+    QCOMPARE(insertedSpy.count() + removedSpy.count() + movedSpy.count(), 0);
+}
+
 void tst_declarativehistorymodel::cleanupTestCase()
 {
     tabModel->clear();
@@ -10,6 +10,7 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "desktopbookmarkwriter.h"
+#include "iconstore.h"
 
 #include <MDesktopEntry>
 #include <QtTest>
@@ -107,6 +108,14 @@ void tst_desktopbookmarkwriter::writeDesktopFile_data()
                             << "   http://www.test1.jolla.com    " << "http://www.test1.jolla.com"
                             << "" << QString(DEFAULT_DESKTOP_BOOKMARK_ICON)
                             << QString(DESKTOP_FILE_PATTERN).arg(testPath, "World", "0");
+
+    QFile iconFile(QString("%1/graphic-browsertutorial.png").arg(TEST_DATA));
+    QVERIFY(iconFile.open(QIODevice::ReadOnly));
+    QString icon = IconStore::instance()->add(iconFile.readAll());
+    QTest::newRow("stored icon")  << "Icon" << "Icon"
+                            << "http://www.test1.jolla.com" << "http://www.test1.jolla.com"
+                            << icon << IconStore::instance()->path(icon)
+                            << QString(DESKTOP_FILE_PATTERN).arg(testPath, "Icon", "0");
 }
 
 void tst_desktopbookmarkwriter::writeDesktopFile()
@@ -4,7 +4,21 @@ NO_COMMON_INCLUDES=1
 include(../test_common.pri)
 include(../../../src/bookmarks.pri)
 
-SOURCES += tst_desktopbookmarkwriter.cpp
+SOURCES += tst_desktopbookmarkwriter.cpp \
+    ../../../src/bookmark.cpp \
+    ../../../src/dbmanager.cpp \
+    ../../../src/dbworker.cpp \
+    ../../../src/internedurl.cpp \
+    ../../../src/link.cpp \
+    ../../../src/tab.cpp
+
+HEADERS += ../../../src/bookmark.h \
+    ../../../src/dbmanager.h \
+    ../../../src/dbworker.h \
+    ../../../src/link.h \
+    ../../../src/tab.h
+
+DEFINES += DB_NAME=\\\"sailfish-browser.sqlite\\\"
 
 CONFIG(desktop) {
     DEFINES += TEST_DATA=\\\"$$PWD/content\\\"
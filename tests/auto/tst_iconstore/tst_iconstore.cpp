@@ -0,0 +1,135 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QBuffer>
+#include <QTemporaryDir>
+
+#include "iconstore.h"
+
+class tst_iconstore : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_iconstore(QObject *parent = 0);
+
+private slots:
+    void init();
+    void contentAddressed();
+    void invalidData();
+    void dataUrl();
+    void scaledImage();
+    void persistent();
+
+private:
+    QByteArray iconData(const QColor &color, int size = 128, const char *format = "png") const;
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QScopedPointer<IconStore> m_store;
+};
+
+tst_iconstore::tst_iconstore(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_iconstore::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_store.reset(new IconStore);
+    m_store->setDirectory(m_dir->path());
+}
+
+QByteArray tst_iconstore::iconData(const QColor &color, int size, const char *format) const
+{
+    QImage image(size, size, QImage::Format_ARGB32);
+    image.fill(color);
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, format);
+    return data;
+}
+
+void tst_iconstore::contentAddressed()
+{
+    QString red = m_store->add(iconData(Qt::red));
+    QVERIFY(IconStore::isHandle(red));
+    QVERIFY(red.startsWith("image://browsericon/"));
+    QCOMPARE(m_store->add(iconData(Qt::red)), red);
+
+    QString blue = m_store->add(iconData(Qt::blue, 128, "jpg"));
+    QVERIFY(blue != red);
+    QVERIFY(m_store->path(blue).endsWith(".jpeg") || m_store->path(blue).endsWith(".jpg"));
+    QVERIFY(m_store->path(red).endsWith(".png"));
+
+    QCOMPARE(QDir(m_dir->path()).entryList(QDir::Files).count(), 2);
+    QCOMPARE(m_store->image(IconStore::hash(red)).pixel(0, 0), QColor(Qt::red).rgb());
+}
+
+void tst_iconstore::invalidData()
+{
+    QVERIFY(m_store->add(QByteArray("<html>not found</html>")).isEmpty());
+    QVERIFY(m_store->add(QByteArray()).isEmpty());
+    QVERIFY(m_store->path("icon-launcher-bookmark").isEmpty());
+    QVERIFY(m_store->path("image://browsericon/0000").isEmpty());
+    QVERIFY(m_store->image("0000").isNull());
+    QVERIFY(IconStore::hash("image://theme/icon-m-service-jolla").isEmpty());
+}
+
+void tst_iconstore::dataUrl()
+{
+    QByteArray data = iconData(Qt::green);
+    QString dataUrl = QString("data:image/png;base64,%1").arg(QString::fromLatin1(data.toBase64()));
+    QVERIFY(IconStore::isDataUrl(dataUrl));
+
+    QString handle = m_store->addDataUrl(dataUrl);
+    QCOMPARE(handle, m_store->add(data));
+
+    // Anything else is kept as is.
+    QCOMPARE(m_store->addDataUrl("icon-launcher-bookmark"), QString("icon-launcher-bookmark"));
+    QCOMPARE(m_store->addDataUrl(handle), handle);
+    QCOMPARE(m_store->addDataUrl("data:image/png;base64,AAAA"), QString("data:image/png;base64,AAAA"));
+}
+
+void tst_iconstore::scaledImage()
+{
+    QString hash = IconStore::hash(m_store->add(iconData(Qt::red, 256)));
+    QCOMPARE(m_store->image(hash).size(), QSize(256, 256));
+    QCOMPARE(m_store->image(hash, QSize(86, 86)).size(), QSize(86, 86));
+    // Icons are not scaled up.
+    QCOMPARE(m_store->image(hash, QSize(512, 512)).size(), QSize(256, 256));
+
+    int memorySize = m_store->memorySize();
+    QVERIFY(memorySize > 0);
+    m_store->image(hash, QSize(86, 86));
+    QCOMPARE(m_store->memorySize(), memorySize);
+
+    m_store->clearMemory();
+    QCOMPARE(m_store->memorySize(), 0);
+}
+
+void tst_iconstore::persistent()
+{
+    QString handle = m_store->add(iconData(Qt::red));
+    QString path = m_store->path(handle);
+
+    // Another store instance finds icons written earlier.
+    IconStore store;
+    store.setDirectory(m_dir->path());
+    QCOMPARE(store.path(handle), path);
+    QVERIFY(!store.image(IconStore::hash(handle)).isNull());
+}
+
+QTEST_MAIN(tst_iconstore)
+#include "tst_iconstore.moc"
@@ -0,0 +1,5 @@
+TARGET = tst_iconstore
+include(../test_common.pri)
+include(../../../src/bookmarks.pri)
+
+SOURCES += tst_iconstore.cpp
@@ -0,0 +1,10 @@
+TARGET = tst_preconnector
+include(../test_common.pri)
+include(../common/qmozcontext_mock.pri)
+
+QT += network
+
+SOURCES += tst_preconnector.cpp \
+    ../../../src/preconnector.cpp
+
+HEADERS += ../../../src/preconnector.h
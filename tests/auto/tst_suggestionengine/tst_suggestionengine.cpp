@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QStandardItemModel>
+
+#include "declarativesuggestionmodel.h"
+#include "suggestionengine.h"
+
+class tst_suggestionengine : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_suggestionengine(QObject *parent = 0);
+
+private slots:
+    void initTestCase();
+    void ranking();
+    void supersededQuery();
+    void latencyBudget();
+    void model();
+
+private:
+    QList<Suggestion> runQuery(SuggestionEngine &engine, int queryId, const QString &filter,
+                               int latencyBudget, bool *partial = 0);
+};
+
+tst_suggestionengine::tst_suggestionengine(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_suggestionengine::initTestCase()
+{
+    qRegisterMetaType<QList<Suggestion> >("QList<Suggestion>");
+}
+
+QList<Suggestion> tst_suggestionengine::runQuery(SuggestionEngine &engine, int queryId, const QString &filter,
+                                                 int latencyBudget, bool *partial)
+{
+    QSignalSpy spy(&engine, SIGNAL(suggestionsAvailable(int,QList<Suggestion>,bool)));
+    engine.supersede(queryId);
+    engine.query(queryId, filter, latencyBudget);
+    if (spy.count() != 1) {
+        return QList<Suggestion>();
+    }
+
+    if (partial) {
+        *partial = spy.at(0).at(2).toBool();
+    }
+    return spy.at(0).at(1).value<QList<Suggestion> >();
+}
+
+void tst_suggestionengine::ranking()
+{
+    SuggestionEngine engine;
+    QList<Suggestion> tabs;
+    tabs << Suggestion(Suggestion::TabSource, "http://www.example.org/tab", "Open tab", 3);
+    QList<Suggestion> bookmarks;
+    bookmarks << Suggestion(Suggestion::BookmarkSource, "http://news.example.org/", "Example news")
+              << Suggestion(Suggestion::BookmarkSource, "http://www.example.org/tab", "Bookmarked tab")
+              << Suggestion(Suggestion::BookmarkSource, "http://foo.com/", "Not matching");
+    engine.setTabs(tabs);
+    engine.setBookmarks(bookmarks);
+
+    bool partial = true;
+    QList<Suggestion> results = runQuery(engine, 1, "example", 1000, &partial);
+    QVERIFY(!partial);
+    QCOMPARE(results.count(), 2);
+
+    // Url prefix match of the open tab ranks first and is suggested once.
+    QCOMPARE(results.at(0).url.toString(), QString("http://www.example.org/tab"));
+    QCOMPARE(results.at(0).source, Suggestion::TabSource);
+    QCOMPARE(results.at(0).tabId, 3);
+    QCOMPARE(results.at(1).url.toString(), QString("http://news.example.org/"));
+
+    QVERIFY(SuggestionEngine::score(tabs.at(0), "example") > SuggestionEngine::score(bookmarks.at(1), "example"));
+    QVERIFY(SuggestionEngine::score(bookmarks.at(0), "news") > SuggestionEngine::score(bookmarks.at(0), "xample"));
+    QCOMPARE(SuggestionEngine::score(bookmarks.at(2), "example"), 0);
+
+    // Often visited history ranks above rarely visited, but below an open tab.
+    Suggestion visited(Suggestion::HistorySource, "http://example.org/visited", "Visited");
+    Suggestion rarelyVisited = visited;
+    visited.visitCount = 5;
+    rarelyVisited.visitCount = 1;
+    QVERIFY(SuggestionEngine::score(visited, "example") > SuggestionEngine::score(rarelyVisited, "example"));
+    visited.visitCount = 1000;
+    QVERIFY(SuggestionEngine::score(visited, "example") < SuggestionEngine::score(tabs.at(0), "example"));
+}
+
+void tst_suggestionengine::supersededQuery()
+{
+    SuggestionEngine engine;
+    QSignalSpy spy(&engine, SIGNAL(suggestionsAvailable(int,QList<Suggestion>,bool)));
+    engine.supersede(2);
+    engine.query(1, "example", 1000);
+    QCOMPARE(spy.count(), 0);
+}
+
+void tst_suggestionengine::latencyBudget()
+{
+    SuggestionEngine engine;
+    QList<Suggestion> bookmarks;
+    for (int i = 0; i < 1000; ++i) {
+        bookmarks << Suggestion(Suggestion::BookmarkSource, QString("http://example.org/%1").arg(i), "Example");
+    }
+    engine.setBookmarks(bookmarks);
+
+    // Used up budget returns what has been found so far, flagged as partial.
+    bool partial = false;
+    QList<Suggestion> results = runQuery(engine, 1, "example", -1, &partial);
+    QVERIFY(partial);
+    QVERIFY(results.count() < bookmarks.count());
+
+    results = runQuery(engine, 2, "example", 1000, &partial);
+    QVERIFY(!partial);
+    QCOMPARE(results.count(), 20);
+}
+
+void tst_suggestionengine::model()
+{
+    QStandardItemModel tabModel;
+    QHash<int, QByteArray> roleNames;
+    roleNames[Qt::UserRole + 1] = "url";
+    roleNames[Qt::UserRole + 2] = "title";
+    roleNames[Qt::UserRole + 3] = "tabId";
+    tabModel.setItemRoleNames(roleNames);
+
+    QStandardItem *item = new QStandardItem;
+    item->setData("http://example.org/", Qt::UserRole + 1);
+    item->setData("Example", Qt::UserRole + 2);
+    item->setData(7, Qt::UserRole + 3);
+    tabModel.appendRow(item);
+
+    DeclarativeSuggestionModel suggestionModel;
+    suggestionModel.setTabModel(&tabModel);
+    QSignalSpy countChangedSpy(&suggestionModel, SIGNAL(countChanged()));
+    suggestionModel.search("example.org");
+    QVERIFY(countChangedSpy.wait());
+    QCOMPARE(suggestionModel.rowCount(), 1);
+
+    QModelIndex index = suggestionModel.index(0);
+    QCOMPARE(suggestionModel.data(index, DeclarativeSuggestionModel::UrlRole).toString(), QString("http://example.org/"));
+    QCOMPARE(suggestionModel.data(index, DeclarativeSuggestionModel::TabIdRole).toInt(), 7);
+    QCOMPARE(suggestionModel.data(index, DeclarativeSuggestionModel::SourceRole).toInt(),
+             (int)DeclarativeSuggestionModel::TabSource);
+
+    // Changes of the source model are picked up by the next search.
+    item->setData("Renamed", Qt::UserRole + 2);
+    QSignalSpy dataChangedSpy(&suggestionModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+    suggestionModel.search("example.org");
+    QVERIFY(dataChangedSpy.wait());
+    QCOMPARE(suggestionModel.data(index, DeclarativeSuggestionModel::TitleRole).toString(), QString("Renamed"));
+}
+
+QTEST_MAIN(tst_suggestionengine)
+#include "tst_suggestionengine.moc"
@@ -0,0 +1,4 @@
+TARGET = tst_suggestionengine
+include(../test_common.pri)
+
+SOURCES += tst_suggestionengine.cpp
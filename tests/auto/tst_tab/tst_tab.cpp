@@ -0,0 +1,165 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QAtomicInt>
+
+#include <cstdlib>
+#include <new>
+
+#include "declarativetabmodel.h"
+#include "internedurl.h"
+#include "tab.h"
+
+// Counts allocations made with operator new while enabled. QString and QList
+// storage is allocated with malloc and hence not counted.
+static QAtomicInt gAllocations;
+static bool gCountAllocations = false;
+
+void *operator new(std::size_t size)
+{
+    if (gCountAllocations) {
+        gAllocations.ref();
+    }
+
+    void *ptr = std::malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) Q_DECL_NOTHROW
+{
+    std::free(ptr);
+}
+
+class tst_tab : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_tab(QObject *parent = 0);
+
+private slots:
+    void implicitSharing();
+    void internedUrls();
+    void restoreTabs_data();
+    void restoreTabs();
+};
+
+tst_tab::tst_tab(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_tab::implicitSharing()
+{
+    Link link(1, "http://foobar", "/tmp/thumb.jpg", "FooBar");
+    Tab tab(1, link, 2, 0);
+    Tab copy(tab);
+    QCOMPARE(copy, tab);
+
+    // Modifying a copy must not leak to the original.
+    copy.setTitle("Changed");
+    QCOMPARE(copy.title(), QString("Changed"));
+    QCOMPARE(tab.title(), QString("FooBar"));
+    QCOMPARE(link.title(), QString("FooBar"));
+    QVERIFY(copy != tab);
+
+    Tab assigned;
+    assigned = tab;
+    QCOMPARE(assigned.url(), QString("http://foobar"));
+    QCOMPARE(assigned.nextLink(), 2);
+
+#ifdef Q_COMPILER_RVALUE_REFS
+    Tab moved(qMove(assigned));
+    QCOMPARE(moved, tab);
+    assigned = qMove(moved);
+    QCOMPARE(assigned, tab);
+#endif
+}
+
+void tst_tab::internedUrls()
+{
+    InternedUrl::squeeze();
+    int poolSize = InternedUrl::poolSize();
+
+    QString url = QString("http://example.com/%1").arg("interned");
+    Link link(1, url, "", "");
+    Tab tab(1, Link(2, QString("http://example.com/") + "interned", "", ""), 0, 0);
+    QCOMPARE(InternedUrl::poolSize(), poolSize + 1);
+
+    // Lookups don't add urls to the pool.
+    QVERIFY(InternedUrl::find(url) == link.internedUrl());
+    QVERIFY(InternedUrl::find("http://example.com/not-interned").isEmpty());
+    QCOMPARE(InternedUrl::poolSize(), poolSize + 1);
+
+    // Equal urls share the pooled string.
+    QVERIFY(link.internedUrl() == tab.internedUrl());
+    QCOMPARE(qHash(link.internedUrl()), qHash(url));
+    QCOMPARE(link.url().constData(), tab.url().constData());
+    QVERIFY(link.internedUrl() != InternedUrl("http://example.com/other"));
+
+    QVERIFY(InternedUrl("").isEmpty());
+    QVERIFY(Link().url().isEmpty());
+
+    // Urls that are no longer referred to are dropped.
+    InternedUrl::squeeze();
+    QCOMPARE(InternedUrl::poolSize(), poolSize + 1);
+
+    url.clear();
+    link = Link();
+    tab = Tab();
+    InternedUrl::squeeze();
+    QCOMPARE(InternedUrl::poolSize(), poolSize);
+}
+
+void tst_tab::restoreTabs_data()
+{
+    QTest::addColumn<int>("tabCount");
+    QTest::newRow("500 tabs") << 500;
+}
+
+/*!
+    Restoring tabs passes the tab list from the database thread to the tab model
+    through a queued signal. Tabs must not be copied one by one on the way.
+*/
+void tst_tab::restoreTabs()
+{
+    QFETCH(int, tabCount);
+
+    QList<Tab> tabs;
+    for (int i = 1; i <= tabCount; ++i) {
+        QString url = QString("http://example.com/%1").arg(i);
+        tabs.append(Tab(i, Link(i, url, QString("/tmp/tab-%1-thumb.jpg").arg(i), url), 0, 0));
+    }
+
+    DeclarativeTabModel tabModel;
+    QSignalSpy countChangedSpy(&tabModel, SIGNAL(countChanged()));
+
+    gAllocations.store(0);
+    gCountAllocations = true;
+    QMetaObject::invokeMethod(&tabModel, "tabsAvailable", Qt::QueuedConnection, Q_ARG(QList<Tab>, tabs));
+    QCoreApplication::processEvents();
+    gCountAllocations = false;
+
+    QCOMPARE(countChangedSpy.count(), 1);
+    QCOMPARE(tabModel.count(), tabCount);
+    QVERIFY(tabModel.activeTab().tabId() > 0);
+
+    int allocations = gAllocations.load();
+    qDebug() << "Allocations during restore of" << tabCount << "tabs:" << allocations;
+    QVERIFY(allocations < tabCount / 10);
+}
+
+QTEST_MAIN(tst_tab)
+#include "tst_tab.moc"
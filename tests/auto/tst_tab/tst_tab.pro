@@ -0,0 +1,4 @@
+TARGET = tst_tab
+include(../test_common.pri)
+
+SOURCES += tst_tab.cpp
@@ -0,0 +1,307 @@
+/****************************************************************************
+**
+** Copyright (C) 2014 Jolla Ltd.
+** Contact: Raine Makelainen <raine.makelainen@jolla.com>
+**
+****************************************************************************/
+
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+#include "thumbnailcache.h"
+
+class tst_thumbnailcache : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_thumbnailcache(QObject *parent = 0);
+
+private slots:
+    void init();
+    void storeVariants();
+    void source();
+    void decodeFromDisk();
+    void memoryLimit();
+    void diskLimit();
+    void remove();
+    void encoding();
+    void current();
+    void contentRect();
+
+    void pipelineProcess();
+    void pipelineEncode_data();
+    void pipelineEncode();
+    void pipelineSignature();
+
+private:
+    QImage testImage(int width, int height) const;
+
+    QScopedPointer<QTemporaryDir> m_dir;
+    QScopedPointer<ThumbnailCache> m_cache;
+};
+
+tst_thumbnailcache::tst_thumbnailcache(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void tst_thumbnailcache::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_cache.reset(new ThumbnailCache);
+    m_cache->setDirectory(m_dir->path());
+    m_cache->setVariantWidth(ThumbnailCache::GridVariant, 200);
+    m_cache->setVariantWidth(ThumbnailCache::CoverVariant, 100);
+}
+
+QImage tst_thumbnailcache::testImage(int width, int height) const
+{
+    QImage image(width, height, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    return image;
+}
+
+void tst_thumbnailcache::storeVariants()
+{
+    QString path = m_cache->store(1, testImage(400, 400));
+    QCOMPARE(path, m_cache->path(1, ThumbnailCache::GridVariant));
+    QVERIFY(QFile::exists(path));
+    // Cover variant is created when requested.
+    QVERIFY(!QFile::exists(m_cache->path(1, ThumbnailCache::CoverVariant)));
+
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant).width(), 200);
+    QCOMPARE(m_cache->image(1, ThumbnailCache::CoverVariant).width(), 100);
+    QVERIFY(QFile::exists(m_cache->path(1, ThumbnailCache::CoverVariant)));
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant, QSize(50, 0)).width(), 50);
+
+    // Storing again drops the cover of the previous thumbnail.
+    m_cache->store(1, testImage(400, 400));
+    QVERIFY(!QFile::exists(m_cache->path(1, ThumbnailCache::CoverVariant)));
+    m_cache->clearMemory();
+    QCOMPARE(m_cache->image(1, ThumbnailCache::CoverVariant, QSize(50, 0)).width(), 50);
+
+    // Smaller images are not scaled up.
+    m_cache->store(2, testImage(150, 150));
+    QCOMPARE(m_cache->image(2, ThumbnailCache::GridVariant).width(), 150);
+    QCOMPARE(m_cache->image(2, ThumbnailCache::CoverVariant).width(), 100);
+}
+
+void tst_thumbnailcache::source()
+{
+    QString first = m_cache->source(1, ThumbnailCache::GridVariant);
+    m_cache->store(1, testImage(400, 400));
+    QString second = m_cache->source(1, ThumbnailCache::GridVariant);
+    QVERIFY(first != second);
+    QVERIFY(second.startsWith("image://thumbnail/1/"));
+    QVERIFY(m_cache->source(1, ThumbnailCache::CoverVariant) != second);
+}
+
+void tst_thumbnailcache::decodeFromDisk()
+{
+    m_cache->store(1, testImage(400, 400));
+    m_cache->clearMemory();
+    QCOMPARE(m_cache->memorySize(), 0);
+
+    // Decoded at the requested size and kept in memory at that size.
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant, QSize(80, 0)).width(), 80);
+    int scaledSize = m_cache->memorySize();
+    QVERIFY(scaledSize > 0);
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant, QSize(80, 0)).width(), 80);
+    QCOMPARE(m_cache->memorySize(), scaledSize);
+
+    // Full size variant is kept in memory.
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant).width(), 200);
+    QVERIFY(m_cache->memorySize() > scaledSize);
+
+    // Scaled images of the previous thumbnail are dropped when it is stored again.
+    m_cache->store(1, testImage(400, 400));
+    QCOMPARE(m_cache->memorySize(), testImage(200, 200).byteCount());
+
+    QVERIFY(m_cache->image(3, ThumbnailCache::GridVariant).isNull());
+}
+
+void tst_thumbnailcache::memoryLimit()
+{
+    int gridBytes = testImage(200, 200).byteCount();
+    m_cache->setMaxMemorySize(3 * gridBytes);
+    for (int tabId = 1; tabId <= 10; ++tabId) {
+        m_cache->store(tabId, testImage(400, 400));
+        QVERIFY(m_cache->memorySize() <= 3 * gridBytes);
+    }
+
+    // Evicted thumbnails are still on disk.
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant).width(), 200);
+}
+
+void tst_thumbnailcache::diskLimit()
+{
+    m_cache->store(1, testImage(400, 400));
+    qint64 tabSize = m_cache->diskSize();
+    QVERIFY(tabSize > 0);
+
+    m_cache->setMaxDiskSize(3 * tabSize);
+    for (int tabId = 2; tabId <= 10; ++tabId) {
+        m_cache->store(tabId, testImage(400, 400));
+        QVERIFY(m_cache->diskSize() <= 3 * tabSize);
+    }
+    QVERIFY(QFile::exists(m_cache->path(10, ThumbnailCache::GridVariant)));
+}
+
+void tst_thumbnailcache::remove()
+{
+    m_cache->store(1, testImage(400, 400));
+    m_cache->image(1, ThumbnailCache::CoverVariant);
+    m_cache->remove(1);
+    QVERIFY(!QFile::exists(m_cache->path(1, ThumbnailCache::GridVariant)));
+    QVERIFY(!QFile::exists(m_cache->path(1, ThumbnailCache::CoverVariant)));
+    QVERIFY(m_cache->image(1, ThumbnailCache::GridVariant).isNull());
+    QCOMPARE(m_cache->memorySize(), 0);
+}
+
+void tst_thumbnailcache::encoding()
+{
+    m_cache->setEncoding(ThumbnailPipeline::Png, 100);
+    QString path = m_cache->store(1, testImage(400, 400));
+    QVERIFY(path.endsWith(".png"));
+    QVERIFY(QFile::exists(path));
+    m_cache->clearMemory();
+    QCOMPARE(m_cache->image(1, ThumbnailCache::GridVariant).pixel(10, 10), QColor(Qt::darkCyan).rgb());
+}
+
+void tst_thumbnailcache::current()
+{
+    QImage image = testImage(400, 400);
+    QByteArray signature = ThumbnailPipeline::signature(image);
+    QString url("http://example.com/");
+    QVERIFY(!m_cache->isCurrent(1, url, signature));
+
+    m_cache->store(1, image, signature, QRectF(), url);
+    QVERIFY(m_cache->isCurrent(1, url, signature));
+    QVERIFY(!m_cache->isCurrent(2, url, signature));
+
+    // Another page with the same look is written.
+    QVERIFY(!m_cache->isCurrent(1, "http://example.com/other", signature));
+
+    // Forgotten signature, e.g. after a black grab, is not current.
+    m_cache->clearSignature(1);
+    QVERIFY(!m_cache->isCurrent(1, url, signature));
+    m_cache->store(1, image, signature, QRectF(), url);
+
+    // Changed page is written again.
+    image.fill(Qt::white);
+    QByteArray changed = ThumbnailPipeline::signature(image);
+    QVERIFY(!m_cache->isCurrent(1, url, changed));
+
+    // Removed thumbnail is never current.
+    QFile::remove(m_cache->path(1, ThumbnailCache::GridVariant));
+    QVERIFY(!m_cache->isCurrent(1, url, signature));
+    m_cache->store(1, image, changed, QRectF(), url);
+    m_cache->remove(1);
+    QVERIFY(!m_cache->isCurrent(1, url, changed));
+}
+
+void tst_thumbnailcache::contentRect()
+{
+    QVERIFY(!m_cache->contains(1));
+    QVERIFY(!m_cache->contentRect(1).isValid());
+
+    QRectF contentRect(0, 1200, 980, 1742);
+    m_cache->store(1, testImage(400, 400), QByteArray(), contentRect);
+    QVERIFY(m_cache->contains(1));
+    QCOMPARE(m_cache->contentRect(1), contentRect);
+
+    m_cache->remove(1);
+    QVERIFY(!m_cache->contains(1));
+    QVERIFY(!m_cache->contentRect(1).isValid());
+}
+
+void tst_thumbnailcache::pipelineProcess()
+{
+    // Left half white, right half black.
+    QImage image(800, 600, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::black);
+    for (int y = 0; y < image.height(); ++y) {
+        QRgb *line = (QRgb *)image.scanLine(y);
+        for (int x = 0; x < image.width() / 2; ++x) {
+            line[x] = qRgb(255, 255, 255);
+        }
+    }
+
+    QImage cropped = ThumbnailPipeline::crop(image, QRect(200, 100, 400, 400));
+    QCOMPARE(cropped.size(), QSize(400, 400));
+    QCOMPARE(cropped.pixel(0, 0), qRgb(255, 255, 255));
+    QCOMPARE(cropped.pixel(399, 0), qRgb(0, 0, 0));
+    QVERIFY(ThumbnailPipeline::crop(image, QRect(900, 0, 10, 10)).isNull());
+
+    QImage processed = ThumbnailPipeline::process(image, QRect(200, 100, 400, 400), 100);
+    QCOMPARE(processed.size(), QSize(100, 100));
+    QCOMPARE(processed.pixel(10, 50), qRgb(255, 255, 255));
+    QCOMPARE(processed.pixel(90, 50), qRgb(0, 0, 0));
+
+    // Processed image does not refer to the source pixels.
+    processed = ThumbnailPipeline::process(image, QRect(0, 0, 50, 50), 100);
+    QCOMPARE(processed.size(), QSize(50, 50));
+    image.fill(Qt::black);
+    QCOMPARE(processed.pixel(10, 10), qRgb(255, 255, 255));
+
+    // Non integral factor.
+    QCOMPARE(ThumbnailPipeline::downscale(testImage(540, 960), 234).size(), QSize(234, 416));
+}
+
+void tst_thumbnailcache::pipelineEncode_data()
+{
+    QTest::addColumn<int>("format");
+    QTest::addColumn<QString>("mimeType");
+
+    QTest::newRow("jpeg") << int(ThumbnailPipeline::Jpeg) << QString("image/jpeg");
+    QTest::newRow("png") << int(ThumbnailPipeline::Png) << QString("image/png");
+}
+
+void tst_thumbnailcache::pipelineEncode()
+{
+    QFETCH(int, format);
+    QFETCH(QString, mimeType);
+
+    ThumbnailPipeline pipeline((ThumbnailPipeline::Format)format, 80);
+    QCOMPARE(pipeline.mimeType(), mimeType);
+
+    QByteArray data = pipeline.encode(testImage(64, 64));
+    QVERIFY(!data.isEmpty());
+    QCOMPARE(QImage::fromData(data).size(), QSize(64, 64));
+    QVERIFY(pipeline.encode(QImage()).isEmpty());
+}
+
+void tst_thumbnailcache::pipelineSignature()
+{
+    QImage image(540, 320, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
+    QByteArray signature = ThumbnailPipeline::signature(image);
+    QCOMPARE(signature.size(), 16 * 16);
+    QVERIFY(ThumbnailPipeline::signaturesMatch(signature, signature));
+    QVERIFY(!ThumbnailPipeline::signaturesMatch(QByteArray(), QByteArray()));
+
+    // A blinking caret does not change the signature.
+    QImage caret = image;
+    for (int y = 100; y < 110; ++y) {
+        caret.setPixel(200, y, qRgb(0, 0, 0));
+    }
+    QVERIFY(ThumbnailPipeline::signaturesMatch(signature, ThumbnailPipeline::signature(caret)));
+
+    // A new block of content does.
+    QImage content = image;
+    for (int y = 100; y < 140; ++y) {
+        for (int x = 200; x < 260; ++x) {
+            content.setPixel(x, y, qRgb(0, 0, 0));
+        }
+    }
+    QVERIFY(!ThumbnailPipeline::signaturesMatch(signature, ThumbnailPipeline::signature(content)));
+}
+
+QTEST_MAIN(tst_thumbnailcache)
+#include "tst_thumbnailcache.moc"
@@ -10,6 +10,9 @@
  * You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <QtTest>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QQuickView>
 #include <qmozcontext.h>
 
@@ -19,6 +22,7 @@
 #include "declarativewebpage.h"
 #include "declarativewebviewcreator.h"
 #include "declarativewebutils.h"
+#include "webpagetrace.h"
 #include "testobject.h"
 
 class tst_webview : public TestObject
@@ -42,6 +46,13 @@ private slots:
     void clear();
     void restart();
     void changeTabAndLoad();
+    void testMemoryPressure();
+    void testMemoryPressureEscalation();
+    void testIdleSweep();
+    void testBackForwardCache();
+    void benchmarkNewTab_data();
+    void benchmarkNewTab();
+    void testLifecycleTrace();
     void cleanupTestCase();
 
 private:
@@ -51,6 +62,7 @@ private:
 
     QString formatUrl(QString fileName) const;
     void verifyHistory(QList<TestTab> &historyOrder);
+    int countTraceEvents(WebPageTrace::EventType type) const;
 
     DeclarativeHistoryModel *historyModel;
     DeclarativeTabModel *tabModel;
@@ -729,6 +741,233 @@ void tst_webview::changeTabAndLoad()
     QCOMPARE(webContainer->m_webPages->m_activePages.count(), 2);
 }
 
+void tst_webview::testMemoryPressure()
+{
+    WebPages *webPages = webContainer->m_webPages.data();
+    int activeTabId = tabModel->activeTab().tabId();
+    QCOMPARE(webPages->count(), 2);
+
+    // Warning level virtualizes inactive pages one by one, least recently used first.
+    webPages->handleMemNotify("warning");
+    QTRY_VERIFY_WITH_TIMEOUT(!webPages->m_memoryPressureTimer.isActive(), 10000);
+    QCOMPARE(webPages->count(), 1);
+    QVERIFY(webPages->m_activePages.alive(activeTabId));
+    QVERIFY(webPages->m_databaseCacheShrunk);
+    // Virtualized page is destroyed after the active page has painted.
+    QTRY_VERIFY_WITH_TIMEOUT(webPages->m_releasedPages.isEmpty(), 5000);
+
+    // Critical only stages are left for the level to rise.
+    int criticalStage = webPages->m_memoryPressureStage;
+    QVERIFY(criticalStage < webPages->m_memoryPressureStages.count());
+    QCOMPARE(webPages->m_memoryPressureStages.at(criticalStage).minimumLevel, WebPages::CriticalMemory);
+
+    webPages->handleMemNotify("normal");
+    QCOMPARE(webPages->m_memoryPressureStage, 0);
+    QVERIFY(!webPages->m_memoryPressureTimer.isActive());
+    QVERIFY(!webPages->m_databaseCacheShrunk);
+}
+
+void tst_webview::testMemoryPressureEscalation()
+{
+    WebPages *webPages = webContainer->m_webPages.data();
+    int activeTabId = tabModel->activeTab().tabId();
+
+    webPages->handleMemNotify("warning");
+    QTRY_VERIFY_WITH_TIMEOUT(!webPages->m_memoryPressureTimer.isActive(), 10000);
+    QVERIFY(webPages->m_memoryPressureStage < webPages->m_memoryPressureStages.count());
+
+    // Escalation to critical runs the stages skipped at warning level.
+    webPages->handleMemNotify("critical");
+    QTRY_COMPARE_WITH_TIMEOUT(webPages->m_memoryPressureStage, webPages->m_memoryPressureStages.count(), 10000);
+    QVERIFY(!webPages->m_memoryPressureTimer.isActive());
+    QVERIFY(webPages->m_activePages.alive(activeTabId));
+    QVERIFY(webPages->m_releasedPages.isEmpty());
+
+    webPages->handleMemNotify("normal");
+    QCOMPARE(webPages->m_memoryPressureStage, 0);
+}
+
+int tst_webview::countTraceEvents(WebPageTrace::EventType type) const
+{
+    int count = 0;
+    QList<WebPageTrace::Event> events = WebPageTrace::instance()->events();
+    for (int i = 0; i < events.count(); ++i) {
+        if (events.at(i).type == type) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void tst_webview::testIdleSweep()
+{
+    WebPages *webPages = webContainer->m_webPages.data();
+    int activeTabId = tabModel->activeTab().tabId();
+
+    int inactiveTabId = 0;
+    foreach (const Tab &tab, tabModel->m_tabs) {
+        if (tab.tabId() != activeTabId) {
+            inactiveTabId = tab.tabId();
+        }
+    }
+
+    // Resurrect the tab virtualized by the memory pressure test.
+    QSignalSpy loadingChanged(webContainer, SIGNAL(loadingChanged()));
+    tabModel->activateTabById(inactiveTabId);
+    waitSignals(loadingChanged, 2);
+    tabModel->activateTabById(activeTabId);
+    QCOMPARE(webPages->count(), 2);
+
+    // Nothing is old enough.
+    webPages->sweepIdlePages();
+    QCOMPARE(webPages->count(), 2);
+    QVERIFY(webPages->m_idleSweepTimer.isActive());
+
+    // Page suspended on deactivation is not suspended again.
+    int suspendEvents = countTraceEvents(WebPageTrace::Suspend);
+    qint64 suspendAge = webPages->m_idleSuspendAge;
+    webPages->m_idleSuspendAge = 0;
+    webPages->sweepIdlePages();
+    webPages->sweepIdlePages();
+    QCOMPARE(countTraceEvents(WebPageTrace::Suspend), suspendEvents);
+    webPages->m_idleSuspendAge = suspendAge;
+
+    qint64 virtualizeAge = webPages->m_idleVirtualizeAge;
+    webPages->m_idleVirtualizeAge = 0;
+    webPages->sweepIdlePages();
+    QCOMPARE(webPages->count(), 1);
+    QVERIFY(webPages->m_activePages.alive(activeTabId));
+    QTRY_VERIFY_WITH_TIMEOUT(webPages->m_releasedPages.isEmpty(), 5000);
+
+    webPages->m_idleVirtualizeAge = virtualizeAge;
+}
+
+void tst_webview::testBackForwardCache()
+{
+    QVariantMap sessionHistory;
+    sessionHistory.insert("index", 1);
+    int sessionHistorySize = 0;
+    {
+        BackForwardCache cache;
+        cache.setSessionHistory(1, sessionHistory);
+        sessionHistorySize = cache.size();
+    }
+    QVERIFY(sessionHistorySize > 0);
+
+    // Cap fits two session histories.
+    BackForwardCache cache(2 * sessionHistorySize, 2);
+    cache.setSessionHistory(1, sessionHistory);
+    QCOMPARE(cache.sessionHistory(1).toMap(), sessionHistory);
+    cache.setSessionHistory(2, sessionHistory);
+    QCOMPARE(cache.size(), 2 * sessionHistorySize);
+    cache.setSessionHistory(1, sessionHistory);
+    cache.setSessionHistory(3, sessionHistory);
+    QCOMPARE(cache.size(), 2 * sessionHistorySize);
+    // Least recently stored history is dropped.
+    QVERIFY(!cache.sessionHistory(2).isValid());
+    QVERIFY(cache.sessionHistory(1).isValid());
+    QVERIFY(cache.sessionHistory(3).isValid());
+
+    // Per tab limit drops the least recently used entry of the tab.
+    cache.storeContentRect(2, "url3", QRectF(0, 50, 480, 800));
+    cache.storeContentRect(2, "url4", QRectF(0, 100, 480, 800));
+    cache.storeContentRect(2, "url3", QRectF(0, 60, 480, 800));
+    cache.storeContentRect(2, "url5", QRectF(0, 150, 480, 800));
+    QVERIFY(!cache.find(2, "url4"));
+    QCOMPARE(cache.find(2, "url3")->contentRect, QRectF(0, 60, 480, 800));
+    QCOMPARE(cache.find(2, "url5")->contentRect, QRectF(0, 150, 480, 800));
+
+    cache.remove(3);
+    cache.remove(2);
+    cache.remove(1);
+    QCOMPARE(cache.size(), 0);
+    QVERIFY(!cache.find(2, "url3"));
+    QVERIFY(!cache.sessionHistory(3).isValid());
+
+    // Navigating back stores the position of the page that was left.
+    int tabId = webContainer->tabId();
+    QString previousUrl = webContainer->url();
+    QString url = formatUrl("testpage.html");
+    load(url, true);
+    QVERIFY(!webContainer->m_backForwardCache.find(tabId, url));
+    goBack();
+    QCOMPARE(webContainer->url(), previousUrl);
+    QVERIFY(webContainer->m_backForwardCache.find(tabId, url));
+}
+
+void tst_webview::benchmarkNewTab_data()
+{
+    QTest::addColumn<int>("sparePages");
+    QTest::newRow("spare pool off") << 0;
+    QTest::newRow("spare pool on") << 1;
+}
+
+/*!
+    Measures latency from a new tab request to the start of loading in the
+    new tab with and without pre-created spare pages.
+*/
+void tst_webview::benchmarkNewTab()
+{
+    QFETCH(int, sparePages);
+
+    WebPages *webPages = webContainer->m_webPages.data();
+    webPages->setMaxSparePages(sparePages);
+    webPages->fillSparePages();
+    QCOMPARE(webPages->m_sparePages.count(), sparePages);
+    if (sparePages > 0) {
+        QTRY_VERIFY_WITH_TIMEOUT(webPages->m_sparePages.at(0)->viewReady(), 5000);
+    }
+
+    int tabCount = tabModel->count();
+    QSignalSpy loadingChanged(webContainer, SIGNAL(loadingChanged()));
+    QElapsedTimer timer;
+    timer.start();
+    tabModel->newTab(formatUrl("testpage.html"), "");
+    while (!webContainer->webPage() || !webContainer->webPage()->loading()) {
+        QVERIFY(loadingChanged.wait(5000));
+    }
+    QTest::setBenchmarkResult(timer.elapsed(), QTest::WalltimeMilliseconds);
+
+    QCOMPARE(webPages->m_sparePages.count(), 0);
+    QTRY_VERIFY_WITH_TIMEOUT(!webContainer->webPage()->loading(), 5000);
+    QTest::qWait(500);
+    QCOMPARE(tabModel->count(), tabCount + 1);
+
+    tabModel->closeActiveTab();
+    webContainer->activatePage(webContainer->tabId());
+    QCOMPARE(tabModel->count(), tabCount);
+}
+
+void tst_webview::testLifecycleTrace()
+{
+    WebPageTrace *trace = WebPageTrace::instance();
+    QList<WebPageTrace::Event> events = trace->events();
+    QVERIFY(!events.isEmpty());
+
+    QSet<int> eventTypes;
+    for (int i = 0; i < events.count(); ++i) {
+        eventTypes.insert(events.at(i).type);
+        if (i > 0) {
+            QVERIFY(events.at(i).timestamp >= events.at(i - 1).timestamp);
+        }
+    }
+    QVERIFY(eventTypes.contains(WebPageTrace::Create));
+    QVERIFY(eventTypes.contains(WebPageTrace::ViewInitialized));
+    QVERIFY(eventTypes.contains(WebPageTrace::Activate));
+    QVERIFY(eventTypes.contains(WebPageTrace::Virtualize));
+    QVERIFY(eventTypes.contains(WebPageTrace::Resurrect));
+    QVERIFY(eventTypes.contains(WebPageTrace::FirstPaint));
+
+    qint64 p50 = trace->percentile(WebPageTrace::NewTransition, 50);
+    QVERIFY(p50 > 0);
+    QVERIFY(trace->percentile(WebPageTrace::NewTransition, 95) >= p50);
+
+    QJsonParseError error;
+    QJsonDocument document = QJsonDocument::fromJson(trace->chromeTrace(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(document.object().value("traceEvents").toArray().count(), events.count());
+}
+
 void tst_webview::cleanupTestCase()
 {
     QTest::qWait(1000);
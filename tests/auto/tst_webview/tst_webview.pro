@@ -15,19 +15,25 @@ isEmpty(QTEMBED_LIB) {
 }
 
 SOURCES += tst_webview.cpp \
+    ../../../src/backforwardcache.cpp \
+    ../../../src/blackframe.cpp \
     ../../../src/declarativewebcontainer.cpp \
     ../../../src/declarativewebpage.cpp \
     ../../../src/declarativewebviewcreator.cpp \
     ../../../src/settingmanager.cpp \
     ../../../src/webpagequeue.cpp \
-    ../../../src/webpages.cpp
+    ../../../src/webpages.cpp \
+    ../../../src/webpagetrace.cpp
 
-HEADERS += ../../../src/declarativewebcontainer.h \
+HEADERS += ../../../src/backforwardcache.h \
+    ../../../src/blackframe.h \
+    ../../../src/declarativewebcontainer.h \
     ../../../src/declarativewebpage.h \
     ../../../src/declarativewebviewcreator.h \
     ../../../src/settingmanager.h \
     ../../../src/webpagequeue.h \
-    ../../../src/webpages.h
+    ../../../src/webpages.h \
+    ../../../src/webpagetrace.h
 
 OTHER_FILES = *.qml
 